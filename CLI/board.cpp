@@ -0,0 +1 @@
+../src/board.cpp
\ No newline at end of file
@@ -0,0 +1 @@
+../src/board.h
\ No newline at end of file
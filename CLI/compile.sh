@@ -13,7 +13,7 @@ CWSDSTUB_URL="http://na.mirror.garr.it/mirrors/djgpp/current/v2/djdev205.zip"
 # Check and compile Linux version if g++ is available
 if command -v g++ &> /dev/null; then
     echo "Compiling Linux version..."
-    g++ minesweeper.cpp highscores.cpp -lncurses -o minesweeper
+    g++ minesweeper.cpp board.cpp highscores.cpp history.cpp -lncurses -o minesweeper
 else
     echo "g++ not found - skipping Linux build"
 fi
@@ -23,7 +23,7 @@ if command -v x86_64-w64-mingw32-g++ &> /dev/null; then
     mkdir -p win_minesweeper
 
     echo "Compiling Windows version (PDCurses) ..."
-    x86_64-w64-mingw32-g++ minesweeper.cpp highscores.cpp -lpdcurses -std=c++14 -o win_minesweeper/minesweepr_pdcurses.exe
+    x86_64-w64-mingw32-g++ minesweeper.cpp board.cpp highscores.cpp history.cpp -lpdcurses -std=c++17 -o win_minesweeper/minesweepr_pdcurses.exe
     ./collect_dlls.sh win_minesweeper/minesweepr_pdcurses.exe /usr/x86_64-w64-mingw32/sys-root/mingw/bin win_minesweeper
 else
     echo "Windows cross-compiler not found - skipping Windows build"
@@ -85,7 +85,7 @@ touch /src/include/term.h
 cd /src
 echo "Building minesweeper for MSDOS..."
 # Add preprocessor define for MSDOS to handle any platform-specific code
-g++ minesweeper.cpp highscores.cpp -o mnsweep.exe -I/src/include -L/src/lib -lpdcurses -DMSDOS
+g++ minesweeper.cpp board.cpp highscores.cpp history.cpp -o mnsweep.exe -I/src/include -L/src/lib -lpdcurses -DMSDOS
 
 # Now embed CWSDPMI directly into the executable
 echo "Embedding CWSDPMI into executable..."
@@ -133,20 +133,17 @@ if [ -f "highscores.h" ]; then
     fi
 fi
 
-# Copy thread.h - your custom file
-if [ -f "thread.h" ]; then
-    THREAD_H_REAL=$(readlink -f thread.h)
-    if [ -f "$THREAD_H_REAL" ]; then
-        echo "Found real thread.h at: $THREAD_H_REAL"
-        cp "$THREAD_H_REAL" "${TEMP_BUILD_DIR}/thread.h"
+# For history.* and board.* - follow the symlinks as well
+for HISTORY_FILE in history.cpp history.h board.cpp board.h; do
+    HISTORY_REAL=$(readlink -f "$HISTORY_FILE")
+    if [ -f "$HISTORY_REAL" ]; then
+        echo "Found real $HISTORY_FILE at: $HISTORY_REAL"
+        cp "$HISTORY_REAL" "${TEMP_BUILD_DIR}/$HISTORY_FILE"
     else
-        # If it's not a symlink, just copy it directly
-        cp -f thread.h "${TEMP_BUILD_DIR}/thread.h"
-        echo "Copied thread.h to build directory"
+        echo "Error: Could not resolve symlink for $HISTORY_FILE"
+        exit 1
     fi
-else
-    echo "Warning: thread.h not found"
-fi
+done
 
 # Copy minesweeper.cpp directly
 cp -L minesweeper.cpp "${TEMP_BUILD_DIR}/"
@@ -1,6 +1,12 @@
+#include "board.h"
 #include "highscores.h"
-#include <atomic>
+#include "history.h"
+#include <algorithm>
 #include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #ifdef _WIN32
 #include <curses.h>
@@ -11,17 +17,15 @@
 #include <ncurses.h>
 #endif
 #endif
+#include <fstream>
+#include <iostream>
 #include <random>
 #include <set>
 #include <string>
-#ifndef MSDOS
-#include <thread>
-#else
-#include "thread.h"
-#endif
 #include <vector>
 
 #define MAX_SCORES 10
+#define MAX_CUSTOM_SIZE 5000
 
 enum class GameState { MENU, PLAYING, HELP, GAME_OVER, HIGHSCORES, ENTER_NAME };
 
@@ -45,18 +49,31 @@ const DifficultySettings DIFFICULTY_SETTINGS[] = {
 };
 
 #ifdef MSDOS
-// For MSDOS, use a simpler Timer class that only uses clock()
+// For MSDOS, use a simpler Timer class without chrono. DJGPP's uclock()
+// reads the PIT directly (about 840ns resolution); plain clock() only
+// ticks every 55ms.
+#ifdef __DJGPP__
+typedef uclock_t TimerTicks;
+#define TIMER_NOW() uclock()
+#define TIMER_TICKS_PER_SEC UCLOCKS_PER_SEC
+#else
+typedef clock_t TimerTicks;
+#define TIMER_NOW() clock()
+#define TIMER_TICKS_PER_SEC CLOCKS_PER_SEC
+#endif
+
 class Timer {
 private:
-  clock_t startTime;
+  TimerTicks startTime;
   bool running;
-  int elapsedSeconds;
+  int elapsedMillis;
+  long long elapsedTicks;
 
 public:
-  Timer() : running(false), elapsedSeconds(0) {}
+  Timer() : running(false), elapsedMillis(0), elapsedTicks(0) {}
 
   void start() {
-    startTime = clock();
+    startTime = TIMER_NOW();
     running = true;
   }
 
@@ -67,33 +84,39 @@ public:
     }
   }
 
-  int getElapsedSeconds() const { return elapsedSeconds; }
+  int getElapsedSeconds() const { return elapsedMillis / 1000; }
+  int getElapsedMillis() const { return elapsedMillis; }
+  long long getElapsedMicros() const {
+    return elapsedTicks * 1000000 / TIMER_TICKS_PER_SEC;
+  }
 
   void update() {
     if (running) {
-      clock_t now = clock();
-      elapsedSeconds = (now - startTime) / CLOCKS_PER_SEC;
+      elapsedTicks = static_cast<long long>(TIMER_NOW() - startTime);
+      elapsedMillis =
+          static_cast<int>(elapsedTicks * 1000 / TIMER_TICKS_PER_SEC);
     }
   }
 
   std::string getTimeString() const {
-    int minutes = elapsedSeconds / 60;
-    int seconds = elapsedSeconds % 60;
-    char buffer[10];
+    int minutes = elapsedMillis / 60000;
+    int seconds = elapsedMillis / 1000 % 60;
+    char buffer[16];
     snprintf(buffer, sizeof(buffer), "%02d:%02d", minutes, seconds);
     return std::string(buffer);
   }
 };
 #else
-// For non-MSDOS, use the chrono-based Timer
+// For non-MSDOS, use the chrono-based Timer. The raw steady_clock duration
+// is kept so nothing is rounded until it is read.
 class Timer {
 private:
   std::chrono::steady_clock::time_point startTime;
+  std::chrono::steady_clock::duration elapsed{};
   bool running;
-  int elapsedSeconds;
 
 public:
-  Timer() : running(false), elapsedSeconds(0) {}
+  Timer() : running(false) {}
 
   void start() {
     startTime = std::chrono::steady_clock::now();
@@ -107,39 +130,63 @@ public:
     }
   }
 
-  int getElapsedSeconds() const { return elapsedSeconds; }
+  int getElapsedSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(elapsed).count();
+  }
+
+  int getElapsedMillis() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(elapsed)
+        .count();
+  }
+
+  long long getElapsedMicros() const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed)
+        .count();
+  }
 
   void update() {
     if (running) {
-      auto now = std::chrono::steady_clock::now();
-      elapsedSeconds =
-          std::chrono::duration_cast<std::chrono::seconds>(now - startTime)
-              .count();
+      elapsed = std::chrono::steady_clock::now() - startTime;
     }
   }
 
   std::string getTimeString() const {
-    int minutes = elapsedSeconds / 60;
-    int seconds = elapsedSeconds % 60;
-    char buffer[10];
+    int totalSeconds = getElapsedSeconds();
+    int minutes = totalSeconds / 60;
+    int seconds = totalSeconds % 60;
+    char buffer[16];
     snprintf(buffer, sizeof(buffer), "%02d:%02d", minutes, seconds);
     return std::string(buffer);
   }
 };
 #endif
 
+// Seed for a board nobody asked for by number
+int randomSeed() {
+#ifdef MSDOS
+  // For MSDOS, use time-based generation with improved distribution
+  unsigned int timeSeed = static_cast<unsigned int>(time(nullptr));
+  int seed = timeSeed ^ (timeSeed << 16); // XOR with shifted version to spread bits
+  seed = ((seed * 1103515245 + 12345) * 65535) &
+         0xFFFFFFFF; // Linear congruential generator
+  return seed;
+#else
+  // For Linux/Windows, use random_device as before
+  std::random_device rd;
+  int seed = rd();
+  if (seed < 0) {
+    seed *= -1;
+  }
+  return seed;
+#endif
+}
+
 class Minesweeper {
 private:
-  std::thread titleThread;
-  std::atomic<bool> running{true};
   int height, width, mines;
-  std::vector<std::vector<bool>> minefield;
-  std::vector<std::vector<bool>> revealed;
-  std::vector<std::vector<bool>> flagged;
+  Board board;
   int cursorY = 0, cursorX = 0;
-  bool gameOver = false;
-  bool won = false;
-  bool firstMove = true;
+  int viewY = 0, viewX = 0; // Top left board cell on screen
   GameState state = GameState::MENU;
   Difficulty difficulty = Difficulty::EASY;
   Timer timer;
@@ -147,6 +194,9 @@ private:
   std::string seedInput;
   bool enteringSeed = false;
   Highscores highscores;
+  GameHistory history{highscores.getDirectory()};
+  int clicks = 0;
+  bool gameRecorded = false;
   std::string playerName;
   bool enteringName = false;
   bool enteringCustom = false;
@@ -155,40 +205,67 @@ private:
   std::string customMines;
   int customStep = 0; // 0=width, 1=height, 2=mines
 
-  bool isHighScore(int time) {
-    const auto &scores = highscores.getScores();
-    std::string currentDifficulty;
+  // What each board cell looked like when last drawn, so a frame only
+  // touches the cells that changed. Empty after anything wipes the screen.
+  std::vector<chtype> shownCells;
+  int shownViewY = -1, shownViewX = -1;
 
-    switch (difficulty) {
-    case Difficulty::EASY:
-      currentDifficulty = "Easy";
-      break;
-    case Difficulty::MEDIUM:
-      currentDifficulty = "Medium";
-      break;
-    case Difficulty::HARD:
-      currentDifficulty = "Hard";
-      break;
-    case Difficulty::CUSTOM:
-      return false;
-    }
-
-    // Count scores for current difficulty
-    int difficultyScores = 0;
-    bool worseThanCurrent = false;
+  // Blanks the screen without clear()'s forced full retransmit; curses
+  // sends only what differs from the terminal on the next refresh
+  void clearScreen() {
+    erase();
+    shownCells.clear();
+  }
 
-    for (const auto &score : scores) {
-      if (score.difficulty == currentDifficulty) {
-        difficultyScores++;
-        if (score.time > time) {
-          worseThanCurrent = true;
-        }
-      }
+  bool firstMove() const { return !board.minesPlaced(); }
+  bool gameOver() const { return board.status() == Board::Status::LOST; }
+  bool won() const { return board.status() == Board::Status::WON; }
+
+  // Board cells that fit on screen below the title and above the two
+  // status lines; each cell is two columns wide
+  int viewRows() const { return std::max(1, std::min(height, LINES - 5)); }
+  int viewCols() const { return std::max(1, std::min(width, COLS / 2)); }
+  bool scrolling() const { return viewRows() < height || viewCols() < width; }
+
+  // Scrolls just far enough to keep the cursor on screen
+  void followCursor() {
+    int rows = viewRows();
+    int cols = viewCols();
+    if (cursorY < viewY) {
+      viewY = cursorY;
+    } else if (cursorY >= viewY + rows) {
+      viewY = cursorY - rows + 1;
     }
+    if (cursorX < viewX) {
+      viewX = cursorX;
+    } else if (cursorX >= viewX + cols) {
+      viewX = cursorX - cols + 1;
+    }
+    viewY = std::max(0, std::min(viewY, height - rows));
+    viewX = std::max(0, std::min(viewX, width - cols));
+  }
 
-    // If we have less than MAX_SCORES for this difficulty, it's automatically a
-    // high score Or if we found a worse score in the current list
-    return difficultyScores < MAX_SCORES || worseThanCurrent;
+  bool isHighScore(int timeMs) {
+    // Custom boards have their own leaderboard per width, height and mines
+    return highscores.isHighScore(timeMs, width, height, mines);
+  }
+
+  // Appends the game to the history once it has been won or lost
+  void recordFinishedGame() {
+    if (firstMove() || gameRecorded ||
+        board.status() == Board::Status::PLAYING)
+      return;
+    timer.stop();
+    gameRecorded = true;
+
+    GameRecord game;
+    game.board = Highscores::packBoard(width, height, mines);
+    game.timeMs = timer.getElapsedMillis();
+    game.bbbv = count3BV(board.minefield());
+    game.clicks = clicks;
+    game.outcome = gameOver() ? GameOutcome::LOST : GameOutcome::WON;
+    game.date = static_cast<uint32_t>(time(nullptr));
+    history.record(game);
   }
 
   void handleCustomDifficulty(int ch) {
@@ -214,8 +291,8 @@ private:
           int m = std::stoi(customMines);
 
           // Validate input
-          w = std::max(5, std::min(w, 30)); // Min 5x5, Max 30x30
-          h = std::max(5, std::min(h, 30));
+          w = std::max(5, std::min(w, MAX_CUSTOM_SIZE));
+          h = std::max(5, std::min(h, MAX_CUSTOM_SIZE));
           m = std::max(
               1, std::min(m, (w * h) -
                                  9)); // At least 9 safe cells for first click
@@ -246,15 +323,18 @@ private:
       if (!currentInput->empty())
         currentInput->pop_back();
     } else if (isdigit(ch)) {
-      if (currentInput->length() < 2) { // Limit input length
+      // Up to 9999 for the sides, which are then clamped, and enough
+      // digits for a mine on nearly every cell of the largest board
+      size_t maxLength = customStep == 2 ? 8 : 4;
+      if (currentInput->length() < maxLength) {
         *currentInput += ch;
       }
     }
   }
 
   void drawHighscores() {
-    clear();
-    mvprintw(2, width, "HIGHSCORES");
+    clearScreen();
+    mvprintw(2, std::min(width, 30), "HIGHSCORES");
 
     const auto &scores = highscores.getScores();
     int row = 4;
@@ -263,27 +343,21 @@ private:
     mvprintw(row++, 2, "----------------------------------------");
 
     for (const auto &score : scores) {
-      // Convert seconds to minutes:seconds format
-      int minutes = score.time / 60;
-      int seconds = score.time % 60;
-      char timeStr[10];
-      snprintf(timeStr, sizeof(timeStr), "%02d:%02d", minutes, seconds);
-
-      mvprintw(row++, 2, "%-20s %-10s %-10s", score.name.c_str(), timeStr,
-               score.difficulty.c_str());
+      mvprintw(row++, 2, "%-20s %-10s %-10s", score.name.c_str(),
+               formatScoreTime(score.timeMs).c_str(), score.difficulty.c_str());
     }
 
     mvprintw(row + 2, 2, "Press any key to return");
   }
 
   void drawEnterName() {
-    clear();
-    refresh(); // Make sure screen is cleared
+    clearScreen();
 
     // Use absolute positions instead of calculated ones for testing
     mvprintw(2, 2, "MINESWEEPER");
     mvprintw(4, 2, "NEW HIGH SCORE!");
-    mvprintw(6, 2, "Your time: %s", timer.getTimeString().c_str());
+    mvprintw(6, 2, "Your time: %s",
+             formatScoreTime(timer.getElapsedMillis()).c_str());
     mvprintw(8, 2, "Enter your name: %s", playerName.c_str());
     mvprintw(10, 2, "Press Enter when done (ESC to cancel)");
 
@@ -294,68 +368,11 @@ private:
     Score score;
     score.name = playerName;
 
-    switch (difficulty) {
-    case Difficulty::EASY:
-      score.difficulty = "Easy";
-      break;
-    case Difficulty::MEDIUM:
-      score.difficulty = "Medium";
-      break;
-    case Difficulty::HARD:
-      score.difficulty = "Hard";
-      break;
-    }
+    score.difficulty = Highscores::boardName(width, height, mines);
 
     highscores.addScore(score);
   }
 
-  void animateTitle() {
-    const std::string title = "MINESWEEPER";
-    int direction = 1;
-    int pos = 0;
-    int maxPos = width - title.length();
-
-    while (running) {
-      if (state == GameState::PLAYING) {
-        move(0, 0);
-        clrtoeol();
-
-        attron(COLOR_PAIR(10) | A_BOLD);
-        mvprintw(0, pos, "%s", title.c_str());
-        attroff(COLOR_PAIR(10) | A_BOLD);
-
-        if (!firstMove && !checkWin()) {
-          timer.update();
-          mvprintw(0, width * 2 + 5, "Time: %s - currentseed: %i",
-                   timer.getTimeString().c_str(), currentSeed);
-        } else if (firstMove) {
-          mvprintw(0, width * 2 + 5, "Time: %s", timer.getTimeString().c_str());
-        } else {
-          mvprintw(0, width * 2 + 5, "Time: %s - currentseed: %i - You win",
-                   timer.getTimeString().c_str(), currentSeed);
-          timer.stop();
-          if (isHighScore(timer.getElapsedSeconds())) {
-            state = GameState::ENTER_NAME;
-            playerName = "";
-          } else {
-            // Just show the high scores without name entry
-            state = GameState::HIGHSCORES;
-          }
-        }
-
-        refresh();
-
-        // This would animate the banner but it's really annoying
-        // pos = (pos + direction)%10;
-      }
-#ifndef MSDOS
-      std::this_thread::sleep_for(std::chrono::milliseconds(500));
-#else
-      return;
-#endif
-    }
-  }
-
   void setupColors() {
     start_color();
     init_pair(1, COLOR_BLUE, COLOR_BLACK);    // 1
@@ -370,180 +387,62 @@ private:
     init_pair(10, COLOR_WHITE, COLOR_BLUE);   // title
   }
 
-  void initializeMinefield(int firstY, int firstX, int seed = -1) {
-    minefield =
-        std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-
-    if (seed == -1) {
-#ifdef MSDOS
-      // For MSDOS, use time-based generation with improved distribution
-      unsigned int timeSeed = static_cast<unsigned int>(time(nullptr));
-      currentSeed = timeSeed ^
-                    (timeSeed << 16); // XOR with shifted version to spread bits
-      currentSeed = ((currentSeed * 1103515245 + 12345) * 65535) &
-                    0xFFFFFFFF; // Linear congruential generator
-#else
-      // For Linux/Windows, use random_device as before
-      std::random_device rd;
-      currentSeed = rd();
-      if (currentSeed < 0) {
-        currentSeed *= -1;
-      }
-#endif
-    } else {
-      currentSeed = seed;
-    }
-
-    std::mt19937 gen(currentSeed);
-    std::uniform_int_distribution<> disH(0, height - 1);
-    std::uniform_int_distribution<> disW(0, width - 1);
-
-    int placedMines = 0;
-    while (placedMines < mines) {
-      int y = disH(gen);
-      int x = disW(gen);
-      if (!minefield[y][x] && (abs(y - firstY) > 1 || abs(x - firstX) > 1)) {
-        minefield[y][x] = true;
-        placedMines++;
-      }
-    }
-  }
-
-  int countAdjacentMines(int y, int x) {
-    int count = 0;
-    for (int dy = -1; dy <= 1; dy++) {
-      for (int dx = -1; dx <= 1; dx++) {
-        int newY = y + dy;
-        int newX = x + dx;
-        if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-          if (minefield[newY][newX])
-            count++;
-        }
-      }
-    }
-    return count;
-  }
-
-  int countAdjacentFlags(int y, int x) {
-    int count = 0;
-    for (int dy = -1; dy <= 1; dy++) {
-      for (int dx = -1; dx <= 1; dx++) {
-        int newY = y + dy;
-        int newX = x + dx;
-        if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-          if (flagged[newY][newX])
-            count++;
-        }
-      }
-    }
-    return count;
-  }
-
-  void revealCell(int y, int x) {
-    if (y < 0 || y >= height || x < 0 || x >= width || revealed[y][x] ||
-        flagged[y][x])
-      return;
-
-    revealed[y][x] = true;
-
-    if (countAdjacentMines(y, x) == 0) {
-      for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-          revealCell(y + dy, x + dx);
-        }
-      }
-    }
-  }
-
-  void revealAdjacentCells(int y, int x) {
-    if (!revealed[y][x])
-      return;
-
-    int mineCount = countAdjacentMines(y, x);
-    int flagCount = countAdjacentFlags(y, x);
-
-    if (mineCount == flagCount) {
-      for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-          int newY = y + dy;
-          int newX = x + dx;
-          if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-            if (!flagged[newY][newX] && !revealed[newY][newX]) {
-              if (minefield[newY][newX]) {
-                gameOver = true;
-                revealAllMines();
-                timer.stop();
-                return;
-              }
-              revealCell(newY, newX);
-            }
-          }
-        }
-      }
-    }
-  }
-
-  void revealAllMines() {
-    for (int y = 0; y < height; y++) {
-      for (int x = 0; x < width; x++) {
-        if (minefield[y][x])
-          revealed[y][x] = true;
-      }
-    }
-  }
-
-  bool checkWin() {
-    for (int y = 0; y < height; y++) {
-      for (int x = 0; x < width; x++) {
-        if (!minefield[y][x] && !revealed[y][x]) {
-          return false;
-        }
-      }
-    }
-    return true;
-  }
-
+  // Title and clock line. Redrawn on its own when only the clock moved.
   void drawTitle() {
+    move(0, 0);
+    clrtoeol();
     attron(COLOR_PAIR(10) | A_BOLD);
     mvprintw(0, 0, "MINESWEEPER");
     attroff(COLOR_PAIR(10) | A_BOLD);
-    if (!firstMove) {
-      mvprintw(0, width * 2 + 5, "Time: %s", timer.getTimeString().c_str());
+
+    // Right of the board, unless the board fills the screen
+    int col = viewCols() < width ? 13 : width * 2 + 5;
+    if (firstMove()) {
+      mvprintw(0, col, "Time: %s", timer.getTimeString().c_str());
+    } else if (won()) {
+      mvprintw(0, col, "Time: %s - currentseed: %i - You win",
+               timer.getTimeString().c_str(), currentSeed);
+    } else {
+      mvprintw(0, col, "Time: %s - currentseed: %i",
+               timer.getTimeString().c_str(), currentSeed);
     }
   }
 
   void drawMenu() {
     std::string seedText;
 
-    clear();
-    mvprintw(height / 2 - 2, width, "MINESWEEPER");
-    mvprintw(height / 2, width, "Select Difficulty:");
-    mvprintw(height / 2 + 1, width, "1. Easy (9x9, 10 mines)");
-    mvprintw(height / 2 + 2, width, "2. Medium (16x16, 40 mines)");
-    mvprintw(height / 2 + 3, width, "3. Hard (16x30, 99 mines)");
-    mvprintw(height / 2 + 4, width, "4. Custom");
+    clearScreen();
+    // Beside where a standard board sits, wherever a custom one reached
+    int top = std::min(height, 16) / 2;
+    int left = std::min(width, 30);
+    mvprintw(top - 2, left, "MINESWEEPER");
+    mvprintw(top, left, "Select Difficulty:");
+    mvprintw(top + 1, left, "1. Easy (9x9, 10 mines)");
+    mvprintw(top + 2, left, "2. Medium (16x16, 40 mines)");
+    mvprintw(top + 3, left, "3. Hard (16x30, 99 mines)");
+    mvprintw(top + 4, left, "4. Custom");
 
     if (enteringCustom) {
-      mvprintw(height / 2 + 5, width, "Enter dimensions (5-30):");
+      mvprintw(top + 5, left, "Enter dimensions (5-%d):", MAX_CUSTOM_SIZE);
       switch (customStep) {
       case 0:
-        mvprintw(height / 2 + 6, width, "Width: %s_", customWidth.c_str());
-        mvprintw(height / 2 + 7, width, "Height: ");
-        mvprintw(height / 2 + 8, width, "Mines: ");
+        mvprintw(top + 6, left, "Width: %s_", customWidth.c_str());
+        mvprintw(top + 7, left, "Height: ");
+        mvprintw(top + 8, left, "Mines: ");
         break;
       case 1:
-        mvprintw(height / 2 + 6, width, "Width: %s", customWidth.c_str());
-        mvprintw(height / 2 + 7, width, "Height: %s_", customHeight.c_str());
-        mvprintw(height / 2 + 8, width, "Mines: ");
+        mvprintw(top + 6, left, "Width: %s", customWidth.c_str());
+        mvprintw(top + 7, left, "Height: %s_", customHeight.c_str());
+        mvprintw(top + 8, left, "Mines: ");
         break;
       case 2:
-        mvprintw(height / 2 + 6, width, "Width: %s", customWidth.c_str());
-        mvprintw(height / 2 + 7, width, "Height: %s", customHeight.c_str());
-        mvprintw(height / 2 + 8, width, "Mines: %s_", customMines.c_str());
+        mvprintw(top + 6, left, "Width: %s", customWidth.c_str());
+        mvprintw(top + 7, left, "Height: %s", customHeight.c_str());
+        mvprintw(top + 8, left, "Mines: %s_", customMines.c_str());
         break;
       }
-      mvprintw(height / 2 + 9, width, "Press Enter to confirm each value");
-      mvprintw(height / 2 + 10, width, "Press ESC to cancel");
+      mvprintw(top + 9, left, "Press Enter to confirm each value");
+      mvprintw(top + 10, left, "Press ESC to cancel");
     } else {
       if (enteringSeed) {
         seedText = seedInput;
@@ -552,34 +451,36 @@ private:
       } else {
         seedText = std::to_string(currentSeed);
       }
-      mvprintw(height / 2 + 6, width, "S. Enter seed (escape for random): %s",
+      mvprintw(top + 6, left, "S. Enter seed (escape for random): %s",
                seedText.c_str());
-      mvprintw(height / 2 + 8, width, "Press 1-4 to start, S for seed");
-      mvprintw(height / 2 + 9, width, "Press H for help");
+      mvprintw(top + 8, left, "Press 1-4 to start, S for seed");
+      mvprintw(top + 9, left, "Press H for help");
     }
   }
 
   void drawHelp() {
-    clear();
+    clearScreen();
     mvprintw(2, 2, "MINESWEEPER HELP");
     mvprintw(4, 2, "Controls:");
     mvprintw(5, 4, "Arrow Keys: Move cursor");
     mvprintw(6, 4, "Space: Reveal cell");
     mvprintw(7, 4, "F: Flag/unflag cell");
-    mvprintw(8, 4, "H: Show/hide help");
-    mvprintw(9, 4, "C: Clear Screen and get rid of any artifacts");
-    mvprintw(10, 4, "N: New Game");
-    mvprintw(11, 4, "R: Reset");
-    mvprintw(12, 4, "K: High Scores");
-    mvprintw(13, 4, "Q: Quit game");
-
-    mvprintw(15, 2, "Tips:");
-    mvprintw(16, 4, "- First click is always safe");
-    mvprintw(17, 4, "- Numbers show adjacent mines");
-    mvprintw(18, 4, "- Flag suspected mines with F");
-    mvprintw(19, 4,
+    mvprintw(8, 4, "PgUp/PgDn, Home/End: Move a screen up/down, to row start/end");
+    mvprintw(9, 4, "G: Jump to the top left corner, Shift+G to the bottom right");
+    mvprintw(10, 4, "H: Show/hide help");
+    mvprintw(11, 4, "C: Clear Screen and get rid of any artifacts");
+    mvprintw(12, 4, "N: New Game");
+    mvprintw(13, 4, "R: Reset");
+    mvprintw(14, 4, "K: High Scores");
+    mvprintw(15, 4, "Q: Quit game");
+
+    mvprintw(17, 2, "Tips:");
+    mvprintw(18, 4, "- First click is always safe");
+    mvprintw(19, 4, "- Numbers show adjacent mines");
+    mvprintw(20, 4, "- Flag suspected mines with F");
+    mvprintw(21, 4,
              "- Press space on revealed numbers to clear adjacent cells");
-    mvprintw(20, 2, "Press any key to return");
+    mvprintw(22, 2, "Press any key to return");
   }
 
   void handleNameEntry(int ch) {
@@ -587,24 +488,14 @@ private:
       if (!playerName.empty()) { // Only accept if name isn't empty
         Score score;
         score.name = playerName;
-        score.time = timer.getElapsedSeconds();
-
-        switch (difficulty) {
-        case Difficulty::EASY:
-          score.difficulty = "Easy";
-          break;
-        case Difficulty::MEDIUM:
-          score.difficulty = "Medium";
-          break;
-        case Difficulty::HARD:
-          score.difficulty = "Hard";
-          break;
-        }
+        score.timeMs = timer.getElapsedMillis();
+
+        score.difficulty = Highscores::boardName(width, height, mines);
 
         highscores.addScore(score);
         state = GameState::HIGHSCORES;
         enteringName = false;
-        clear(); // Clear screen before showing highscores
+        clearScreen();
       }
     } else if (ch == KEY_BACKSPACE || ch == 127 || ch == '\b') {
       if (!playerName.empty()) {
@@ -614,7 +505,7 @@ private:
       // Allow canceling name entry, go straight to highscores
       state = GameState::HIGHSCORES;
       enteringName = false;
-      clear();
+      clearScreen();
     } else if (isprint(ch) && playerName.length() < 20) {
       playerName += ch;
     }
@@ -624,14 +515,6 @@ public:
   Minesweeper() {
     setupColors();
     setDifficulty(Difficulty::EASY);
-    titleThread = std::thread(&Minesweeper::animateTitle, this);
-  }
-
-  ~Minesweeper() {
-    running = false;
-    if (titleThread.joinable()) {
-      titleThread.join();
-    }
   }
 
   void setDifficulty(Difficulty diff) {
@@ -644,27 +527,23 @@ public:
   }
 
   void reset() {
-    revealed =
-        std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-    flagged =
-        std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-    firstMove = true;
-    gameOver = false;
-    won = false;
+    board = Board(width, height, mines, currentSeed);
+    clicks = 0;
+    gameRecorded = false;
     cursorY = 0;
     cursorX = 0;
+    viewY = 0;
+    viewX = 0;
     timer = Timer();
-    clear();
+    clearScreen();
     seedInput.clear();
     enteringSeed = false;
   }
 
   void draw() {
-#ifdef MSDOS
-    if (state == GameState::PLAYING && !firstMove && !gameOver && !won) {
+    if (state == GameState::PLAYING && !firstMove() && !gameOver() && !won()) {
       timer.update();
     }
-#endif
 
     if (state == GameState::ENTER_NAME) {
       drawEnterName();
@@ -685,73 +564,109 @@ public:
       drawHelp();
       return;
     }
-#ifdef MSDOS
-    animateTitle();
-#endif
+    drawTitle();
 
-    for (int y = 0; y < height; y++) {
-      for (int x = 0; x < width; x++) {
-        move(y + 2, x * 2); // +2 for title space
-        if (y == cursorY && x == cursorX) {
-          attron(A_REVERSE);
-        }
+    drawBoard();
 
-        if (flagged[y][x]) {
-          if (!firstMove) {
-            attron(COLOR_PAIR(9));
-            addch('F');
-            addch(' ');
-            attroff(COLOR_PAIR(9));
-          }
-        } else if (!revealed[y][x]) {
-          addch('#');
-          addch(' ');
-        } else if (minefield[y][x]) {
-          attron(COLOR_PAIR(8) | A_BOLD);
-          addch('*');
-          addch(' ');
-          attroff(COLOR_PAIR(8) | A_BOLD);
-        } else {
-          int count = countAdjacentMines(y, x);
-          if (count == 0) {
-            addch(' ');
-            addch(' ');
-          } else {
-            attron(COLOR_PAIR(count) | A_BOLD);
-            addch('0' + count);
-            addch(' ');
-            attroff(COLOR_PAIR(count) | A_BOLD);
-          }
-        }
+    // Status and instructions
+    int rows = viewRows();
+    mvprintw(rows + 3, 0,
+             "Press 'h' for help | Space=Reveal | F=Flag | Q=Quit");
+
+    if (gameOver()) {
+      mvprintw(rows + 4, 0,
+               "Game Over! Press 'q' to quit or 'r' to restart.");
+    } else if (won()) {
+      mvprintw(rows + 4, 0,
+               "You Won! Time: %s | Press 'q' to quit or 'r' to restart.",
+               timer.getTimeString().c_str());
+    }
+    refresh();
+  }
 
+  // Cell glyph with its colour and attributes; drawn followed by a blank
+  chtype cellGlyph(int y, int x) {
+    if (board.isFlagged(y, x)) {
+      return firstMove() ? ' ' : 'F' | COLOR_PAIR(9);
+    }
+    if (!board.isRevealed(y, x)) {
+      return '#';
+    }
+    if (board.isMine(y, x)) {
+      return '*' | COLOR_PAIR(8) | A_BOLD;
+    }
+    int count = board.adjacentMines(y, x);
+    return count == 0 ? ' ' : ('0' + count) | COLOR_PAIR(count) | A_BOLD;
+  }
+
+  // Draws the cells in the viewport only, so the cost follows the terminal
+  // size rather than the board size. When the viewport has moved every
+  // cell on screen changes, so the shadow starts over.
+  void drawBoard() {
+    followCursor();
+    int rows = viewRows();
+    int cols = viewCols();
+    size_t cells = static_cast<size_t>(rows) * cols;
+    if (shownCells.size() != cells || shownViewY != viewY ||
+        shownViewX != viewX) {
+      shownCells.assign(cells, 0); // Never a real glyph, so all are drawn
+      shownViewY = viewY;
+      shownViewX = viewX;
+    }
+    for (int row = 0; row < rows; row++) {
+      int y = viewY + row;
+      for (int col = 0; col < cols; col++) {
+        int x = viewX + col;
+        chtype glyph = cellGlyph(y, x);
         if (y == cursorY && x == cursorX) {
-          attroff(A_REVERSE);
+          glyph |= A_REVERSE;
+        }
+        chtype &shown = shownCells[static_cast<size_t>(row) * cols + col];
+        if (shown == glyph) {
+          continue;
         }
+        shown = glyph;
+        mvaddch(row + 2, col * 2, glyph); // +2 for title space
+        addch(' ' | (glyph & A_REVERSE));
       }
     }
 
-    // Status and instructions
-    mvprintw(height + 3, 0,
-             "Press 'h' for help | Space=Reveal | F=Flag | Q=Quit");
-#ifdef MSDOS
-    animateTitle();
-#endif
+    // Where the view is, on the otherwise empty line under the title
+    move(1, 0);
+    clrtoeol();
+    if (scrolling()) {
+      mvprintw(1, 0, "Rows %d-%d of %d, columns %d-%d of %d, cursor %d,%d",
+               viewY + 1, viewY + rows, height, viewX + 1, viewX + cols, width,
+               cursorY + 1, cursorX + 1);
+    }
+  }
 
-    if (gameOver) {
-      mvprintw(height + 4, 0,
-               "Game Over! Press 'q' to quit or 'r' to restart.");
-    } else if (won) {
-      mvprintw(height + 4, 0,
-               "You Won! Time: %s | Press 'q' to quit or 'r' to restart.",
-               timer.getTimeString().c_str());
+  // Milliseconds until the clock on screen next changes, or -1 when it is
+  // stopped and input may be waited for indefinitely
+  int nextTickDelay() {
+    if (state != GameState::PLAYING || firstMove() || gameOver() || won()) {
+      return -1;
     }
-#ifdef MSDOS
-    animateTitle();
-#endif
+    timer.update();
+    return 1000 - timer.getElapsedMillis() % 1000;
+  }
+
+  // Called when the tick deadline passes without input
+  void tick() {
+    if (nextTickDelay() < 0) {
+      return;
+    }
+    drawTitle();
     refresh();
   }
 
   bool handleInput(int ch) {
+#ifdef KEY_RESIZE
+    if (ch == KEY_RESIZE) {
+      clearScreen();
+      return true;
+    }
+#endif
     if (state == GameState::ENTER_NAME) {
       handleNameEntry(ch);
       return true;
@@ -792,17 +707,17 @@ public:
       case '1':
         setDifficulty(Difficulty::EASY);
         state = GameState::PLAYING;
-        clear();
+        clearScreen();
         break;
       case '2':
         setDifficulty(Difficulty::MEDIUM);
         state = GameState::PLAYING;
-        clear();
+        clearScreen();
         break;
       case '3':
         setDifficulty(Difficulty::HARD);
         state = GameState::PLAYING;
-        clear();
+        clearScreen();
         break;
       case '4':
         enteringCustom = true;
@@ -828,11 +743,10 @@ public:
 
     if (state == GameState::HELP) {
       state = GameState::PLAYING;
-      clear();
+      clearScreen();
       return true;
     }
 
-    drawTitle();
     switch (ch) {
     case KEY_UP:
       if (cursorY > 0)
@@ -850,41 +764,63 @@ public:
       if (cursorX < width - 1)
         cursorX++;
       break;
-    case ' ':
-      if (firstMove) {
-        initializeMinefield(cursorY, cursorX, currentSeed);
-        firstMove = false;
+    case KEY_PPAGE:
+      cursorY = std::max(0, cursorY - viewRows());
+      break;
+    case KEY_NPAGE:
+      cursorY = std::min(height - 1, cursorY + viewRows());
+      break;
+    case KEY_HOME:
+      cursorX = 0;
+      break;
+    case KEY_END:
+      cursorX = width - 1;
+      break;
+    case 'g':
+      cursorY = 0;
+      cursorX = 0;
+      break;
+    case 'G':
+      cursorY = height - 1;
+      cursorX = width - 1;
+      break;
+    case ' ': {
+      if (board.status() != Board::Status::PLAYING) {
+        break;
+      }
+      clicks++;
+      if (firstMove()) {
+        if (currentSeed == -1) {
+          currentSeed = randomSeed();
+        }
+        board.setSeed(currentSeed);
         timer.start();
       }
-      if (revealed[cursorY][cursorX]) {
-        revealAdjacentCells(cursorY, cursorX);
-      } else if (!flagged[cursorY][cursorX]) {
-        if (minefield[cursorY][cursorX]) {
-          gameOver = true;
-          revealAllMines();
-          timer.stop();
+      if (board.isRevealed(cursorY, cursorX)) {
+        board.chord(cursorY, cursorX);
+      } else {
+        board.reveal(cursorY, cursorX);
+      }
+      if (gameOver()) {
+        timer.stop();
+      }
+      // A chord can win the game as well as a plain reveal
+      if (won()) {
+        timer.stop();
+        if (isHighScore(timer.getElapsedMillis())) {
+          state = GameState::ENTER_NAME;
+          playerName = "";
         } else {
-          revealCell(cursorY, cursorX);
-          if (!won) {
-            won = checkWin();
-            if (won) {
-              timer.stop();
-              if (isHighScore(timer.getElapsedSeconds())) {
-                state = GameState::ENTER_NAME;
-                playerName = "";
-              } else {
-                // Just show the high scores without name entry
-                state = GameState::HIGHSCORES;
-              }
-            }
-          }
+          // Just show the high scores without name entry
+          state = GameState::HIGHSCORES;
         }
       }
       break;
+    }
     case 'f':
     case 'F':
-      if (!revealed[cursorY][cursorX]) {
-        flagged[cursorY][cursorX] = !flagged[cursorY][cursorX];
+      if (board.toggleFlag(cursorY, cursorX)) {
+        clicks++;
       }
       break;
     case 'h':
@@ -902,11 +838,12 @@ public:
       break;
     case 'c':
     case 'C':
-      clear();
+      clear(); // Retransmits everything, fixing a garbled terminal
+      shownCells.clear();
       break;
     /*case 'k':
     case 'K':
-        if (isHighScore(timer.getElapsedSeconds())) {
+        if (isHighScore(timer.getElapsedMillis())) {
             state = GameState::ENTER_NAME;
             playerName = "";
         } else {
@@ -918,12 +855,409 @@ public:
     case 'Q':
       return false;
     }
+    recordFinishedGame();
     return true;
   }
-  bool isGameOver() const { return gameOver || won; }
+  bool isGameOver() const { return gameOver() || won(); }
 };
 
-int main() {
+// Words and encodings shared by --batch and --bot
+
+// First word of a line; rest is left just past it
+std::string firstWord(const char *text, const char **rest) {
+  while (*text == ' ' || *text == '\t') {
+    text++;
+  }
+  const char *end = text;
+  while (*end && *end != ' ' && *end != '\t' && *end != '\r') {
+    end++;
+  }
+  *rest = end;
+  return std::string(text, end);
+}
+
+// Exactly count integers and nothing else. strtol rather than sscanf,
+// which would dominate the run time on a large corpus.
+bool scanNumbers(const char *text, int *values, int count) {
+  for (int i = 0; i < count; i++) {
+    char *end;
+    long value = strtol(text, &end, 10);
+    if (end == text || value < INT_MIN || value > INT_MAX) {
+      return false;
+    }
+    values[i] = static_cast<int>(value);
+    text = end;
+  }
+  while (*text == ' ' || *text == '\t' || *text == '\r') {
+    text++;
+  }
+  return *text == '\0';
+}
+
+// The same limits as the custom game menu
+bool validBoard(int width, int height, int mines) {
+  return width >= 5 && width <= MAX_CUSTOM_SIZE && height >= 5 &&
+         height <= MAX_CUSTOM_SIZE && mines >= 1 && mines <= width * height - 9;
+}
+
+// 'r', 'f' or 'c' for a move word, 0 for anything else
+int moveOf(const std::string &word) {
+  if (word == "reveal" || word == "r") {
+    return 'r';
+  } else if (word == "flag" || word == "f") {
+    return 'f';
+  } else if (word == "chord" || word == "c") {
+    return 'c';
+  }
+  return 0;
+}
+
+bool applyMove(Board &board, int move, int row, int col) {
+  switch (move) {
+  case 'r':
+    return board.reveal(row, col);
+  case 'f':
+    return board.toggleFlag(row, col);
+  default:
+    return board.chord(row, col);
+  }
+}
+
+// '#' hidden, 'F' flagged, '*' mine, '.' blank, '1'-'8' numbers
+char cellChar(const Board &board, int row, int col) {
+  if (board.isFlagged(row, col)) {
+    return 'F';
+  } else if (!board.isRevealed(row, col)) {
+    return '#';
+  } else if (board.isMine(row, col)) {
+    return '*';
+  }
+  int count = board.adjacentMines(row, col);
+  return count == 0 ? '.' : static_cast<char>('0' + count);
+}
+
+// Every cell, rows split by '/'
+void appendCells(const Board &board, std::string &out) {
+  for (int row = 0; row < board.height(); row++) {
+    if (row > 0) {
+      out += '/';
+    }
+    for (int col = 0; col < board.width(); col++) {
+      out += cellChar(board, row, col);
+    }
+  }
+}
+
+const char *statusName(Board::Status status) {
+  switch (status) {
+  case Board::Status::WON:
+    return "won";
+  case Board::Status::LOST:
+    return "lost";
+  default:
+    return "playing";
+  }
+}
+
+// --batch: plays scripted games through Board with no terminal at all, for
+// running large regression corpora. The script is read line by line:
+//
+//   # comment
+//   game WIDTH HEIGHT MINES SEED   starts a game; ends the one before
+//   reveal ROW COL                 also r; rows and columns count from 0
+//   flag ROW COL                   also f
+//   chord ROW COL                  also c
+//   end                            optional; the next game or EOF also ends
+//
+// Every game becomes one JSON line with its outcome, counts, the time spent
+// in the engine and the final board as appendCells() writes it.
+// Script errors become {"line":N,"error":...} lines, and a summary line
+// ends the output.
+class BatchRunner {
+public:
+  int run(std::istream &in) {
+    Timer total;
+    total.start();
+    std::string line;
+    while (std::getline(in, line)) {
+      lineNumber++;
+      handleLine(line);
+    }
+    finishGame();
+    total.stop();
+
+    long long micros = total.getElapsedMicros();
+    printf("{\"summary\":true,\"games\":%ld,\"moves\":%ld,\"errors\":%ld,"
+           "\"elapsed_us\":%lld,\"moves_per_second\":%.0f}\n",
+           games, totalMoves, errors, micros,
+           micros > 0 ? totalMoves * 1e6 / micros : 0.0);
+    fflush(stdout);
+    return errors == 0 ? 0 : 1;
+  }
+
+private:
+  Board board;
+  bool inGame = false;
+  long lineNumber = 0;
+  long gameLine = 0;
+  int moves = 0;
+  int applied = 0;
+  Timer engine; // Only runs while a move is applied
+  long long engineMicros = 0;
+  long games = 0;
+  long totalMoves = 0;
+  long errors = 0;
+  std::string cells;
+
+  void error(const char *message) {
+    errors++;
+    printf("{\"line\":%ld,\"error\":\"%s\"}\n", lineNumber, message);
+  }
+
+  void handleLine(const std::string &line) {
+    int values[4];
+    const char *rest;
+    std::string command = firstWord(line.c_str(), &rest);
+    if (command.empty() || command[0] == '#') {
+      return; // Blank or comment
+    }
+
+    if (command == "game") {
+      finishGame(); // A bad game line still ends the one before
+      if (!scanNumbers(rest, values, 4)) {
+        error("game needs WIDTH HEIGHT MINES SEED");
+        return;
+      }
+      if (!validBoard(values[0], values[1], values[2]) || values[3] < 0) {
+        error("board out of range");
+        return;
+      }
+      board = Board(values[0], values[1], values[2], values[3]);
+      inGame = true;
+      gameLine = lineNumber;
+      moves = 0;
+      applied = 0;
+      engineMicros = 0;
+      return;
+    }
+    if (command == "end") {
+      finishGame();
+      return;
+    }
+
+    int move = moveOf(command);
+    if (move == 0) {
+      error("unknown command");
+      return;
+    }
+    if (!inGame) {
+      error("move outside a game");
+    } else if (!scanNumbers(rest, values, 2)) {
+      error("move needs ROW COL");
+    } else if (!board.contains(values[0], values[1])) {
+      error("move off the board");
+    } else {
+      moves++;
+      totalMoves++;
+      engine = Timer();
+      engine.start();
+      bool changed = applyMove(board, move, values[0], values[1]);
+      engine.stop();
+      engineMicros += engine.getElapsedMicros();
+      if (changed) {
+        applied++;
+      }
+    }
+  }
+
+  void finishGame() {
+    if (!inGame) {
+      return;
+    }
+    inGame = false;
+    games++;
+
+    const char *outcome = board.status() == Board::Status::PLAYING
+                              ? "unfinished"
+                              : statusName(board.status());
+    cells.clear();
+    appendCells(board, cells);
+
+    printf("{\"game\":%ld,\"line\":%ld,\"width\":%d,\"height\":%d,"
+           "\"mines\":%d,\"seed\":%d,\"outcome\":\"%s\",\"moves\":%d,"
+           "\"applied\":%d,\"revealed\":%d,\"flags\":%d,"
+           "\"engine_us\":%lld,\"board\":\"%s\"}\n",
+           games, gameLine, board.width(), board.height(), board.mines(),
+           board.seed(), outcome, moves, applied, board.revealedSafe(),
+           board.flags(), engineMicros,
+           cells.c_str());
+  }
+};
+
+// --bot: one game at a time for an external player over a pipe. Every
+// request line gets exactly one reply line:
+//
+//   new WIDTH HEIGHT MINES [SEED]  ok WIDTH HEIGHT MINES SEED
+//   reveal|flag|chord ROW COL      ok STATUS  (also r, f and c)
+//   state                          state STATUS N ROW COL CELL ...
+//   board                          board STATUS CELLS
+//   quit                           bye
+//
+// STATUS is playing, won or lost and CELL is a cellChar(). state lists only
+// the N cells that look different from the last state or board reply, or
+// from an all hidden board after new, so a turn costs what it changed
+// rather than the whole board. Anything else is answered with error and a
+// reason. Replies are flushed once no further requests are waiting, so a
+// player that sends several requests at once gets the replies together.
+class BotSession {
+public:
+  int run(std::istream &in) {
+    std::string line;
+    while (std::getline(in, line)) {
+      reply.clear();
+      bool more = handleLine(line);
+      reply += '\n';
+      fwrite(reply.data(), 1, reply.size(), stdout);
+      if (!more) {
+        break;
+      }
+      if (in.rdbuf()->in_avail() <= 0) {
+        fflush(stdout);
+      }
+    }
+    fflush(stdout);
+    return 0;
+  }
+
+private:
+  Board board;
+  bool inGame = false;
+  std::vector<char> reported; // Each cell as the player last saw it
+  std::vector<int> changed;   // Cells the board touched since then
+  std::string reply;
+
+  bool handleLine(const std::string &line) {
+    int values[4];
+    const char *rest;
+    std::string command = firstWord(line.c_str(), &rest);
+
+    if (command == "new") {
+      bool seeded = scanNumbers(rest, values, 4);
+      if (!seeded && !scanNumbers(rest, values, 3)) {
+        reply = "error new needs WIDTH HEIGHT MINES [SEED]";
+      } else if (!validBoard(values[0], values[1], values[2]) ||
+                 (seeded && values[3] < 0)) {
+        reply = "error board out of range";
+      } else {
+        board = Board(values[0], values[1], values[2],
+                      seeded ? values[3] : randomSeed());
+        board.trackChanges(&changed);
+        changed.clear();
+        reported.assign(static_cast<size_t>(board.width()) * board.height(),
+                        '#');
+        inGame = true;
+        reply = "ok " + std::to_string(board.width()) + ' ' +
+                std::to_string(board.height()) + ' ' +
+                std::to_string(board.mines()) + ' ' +
+                std::to_string(board.seed());
+      }
+    } else if (command == "quit") {
+      reply = "bye";
+      return false;
+    } else if (command != "state" && command != "board" &&
+               moveOf(command) == 0) {
+      reply = "error unknown command";
+    } else if (!inGame) {
+      reply = "error no game; send new first";
+    } else if (command == "state") {
+      sendChanges();
+    } else if (command == "board") {
+      sendBoard();
+    } else if (!scanNumbers(rest, values, 2)) {
+      reply = "error move needs ROW COL";
+    } else if (!board.contains(values[0], values[1])) {
+      reply = "error move off the board";
+    } else {
+      applyMove(board, moveOf(command), values[0], values[1]);
+      reply = "ok ";
+      reply += statusName(board.status());
+    }
+    return true;
+  }
+
+  // A cell can be listed more than once, or flagged and unflagged in
+  // between; comparing with what was sent drops both
+  void sendChanges() {
+    std::string cells;
+    int count = 0;
+    int width = board.width();
+    for (int index : changed) {
+      int row = index / width;
+      int col = index % width;
+      char now = cellChar(board, row, col);
+      if (reported[index] == now) {
+        continue;
+      }
+      reported[index] = now;
+      count++;
+      cells += ' ';
+      cells += std::to_string(row);
+      cells += ' ';
+      cells += std::to_string(col);
+      cells += ' ';
+      cells += now;
+    }
+    changed.clear();
+    reply = "state ";
+    reply += statusName(board.status());
+    reply += ' ';
+    reply += std::to_string(count);
+    reply += cells;
+  }
+
+  void sendBoard() {
+    reply = "board ";
+    reply += statusName(board.status());
+    reply += ' ';
+    appendCells(board, reply);
+    for (int row = 0; row < board.height(); row++) {
+      for (int col = 0; col < board.width(); col++) {
+        reported[static_cast<size_t>(row) * board.width() + col] =
+            cellChar(board, row, col);
+      }
+    }
+    changed.clear();
+  }
+};
+
+int main(int argc, char *argv[]) {
+  if (argc == 2 && strcmp(argv[1], "--bot") == 0) {
+    std::ios::sync_with_stdio(false);
+    static char buffer[1 << 16];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    BotSession session;
+    return session.run(std::cin);
+  }
+  if (argc >= 2 && strcmp(argv[1], "--batch") == 0) {
+    if (argc > 3) {
+      fprintf(stderr, "Usage: %s --batch [SCRIPT]\n", argv[0]);
+      return 2;
+    }
+    std::ios::sync_with_stdio(false);
+    static char buffer[1 << 16];
+    setvbuf(stdout, buffer, _IOFBF, sizeof(buffer));
+    BatchRunner runner;
+    if (argc == 2 || strcmp(argv[2], "-") == 0) {
+      return runner.run(std::cin);
+    }
+    std::ifstream script(argv[2]);
+    if (!script) {
+      fprintf(stderr, "Cannot open %s\n", argv[2]);
+      return 2;
+    }
+    return runner.run(script);
+  }
+
   initscr();
   raw();
   keypad(stdscr, TRUE);
@@ -933,10 +1267,21 @@ int main() {
   Minesweeper game;
   bool running = true;
 
+  // One thread does all drawing. getch() waits for a key or for the clock
+  // on screen to change, whichever is first, and blocks outright when no
+  // game is running.
+  game.draw();
   while (running) {
-    game.draw();
+    timeout(game.nextTickDelay());
     int ch = getch();
+    if (ch == ERR) {
+      game.tick();
+      continue;
+    }
     running = game.handleInput(ch);
+    if (running) {
+      game.draw();
+    }
   }
 
   endwin();
@@ -0,0 +1 @@
+../src/scoreprotocol.h
\ No newline at end of file
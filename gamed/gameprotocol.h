@@ -0,0 +1,107 @@
+#pragma once
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Wire protocol of minesweeper-gamed. Framed like ScoreProtocol: a u32
+// payload length, then the payload, integers little-endian. Requests may be
+// pipelined; replies come back in request order. A request payload starts
+// with its opcode and a reply payload with a status; only OK replies carry
+// the fields listed.
+//
+//   NEW    u16 width, u16 height, u32 mines, u32 seed (RANDOM_SEED picks one)
+//          -> u32 game, u32 seed
+//   MOVE   u32 game, u8 move, u16 row, u16 col
+//          -> u8 game status, u32 count, then count x (u16 row, u16 col,
+//             u8 cell) for each cell the move changed
+//   STATE  u32 game
+//          -> u8 game status, u16 width, u16 height, width x height cells
+//   CLOSE  u32 game
+//          -> nothing more
+//
+// A game belongs to the connection that created it and ends with it.
+namespace GameProtocol {
+    const char* const SOCKET_NAME = "minesweeper-gamed.sock";
+    const uint32_t MAX_FRAME = 4 << 20;
+    const int MAX_SIDE = 1024;  // Keeps a STATE reply inside one frame
+    const uint32_t RANDOM_SEED = 0xFFFFFFFF;
+
+    // Socket used without --socket: one inside $XDG_RUNTIME_DIR, which only
+    // its own user can enter. Empty when that variable is not set, and then
+    // the path has to be given.
+    inline std::string defaultSocket() {
+        const char* runtime = getenv("XDG_RUNTIME_DIR");
+        if (!runtime || !*runtime) return std::string();
+        return std::string(runtime) + "/" + SOCKET_NAME;
+    }
+
+    enum Opcode : uint8_t {
+        NEW = 1,
+        MOVE = 2,
+        STATE = 3,
+        CLOSE = 4
+    };
+
+    enum Move : uint8_t {
+        REVEAL = 0,
+        FLAG = 1,
+        CHORD = 2
+    };
+
+    enum Status : uint8_t {
+        OK = 0,
+        BAD_REQUEST = 2,
+        NO_GAME = 3
+    };
+
+    // Same values as Board::Status
+    enum GameStatus : uint8_t {
+        PLAYING = 0,
+        WON = 1,
+        LOST = 2
+    };
+
+    // Cells: 0-8 is a revealed number, then these
+    enum Cell : uint8_t {
+        HIDDEN = 9,
+        FLAGGED = 10,
+        MINE = 11
+    };
+
+    inline void putU8(std::string& out, uint8_t value) {
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline void putU16(std::string& out, uint16_t value) {
+        for (int i = 0; i < 2; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    inline void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    // Little-endian integer of the given width at data; the caller has
+    // checked the length
+    inline uint32_t get(const char* data, size_t bytes) {
+        uint32_t value = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+        }
+        return value;
+    }
+
+    // Starts a frame in out and returns where its length goes; endFrame()
+    // fills it in once the payload has been appended. Replies are built in
+    // place in the output buffer this way, with no copy per frame.
+    inline size_t beginFrame(std::string& out) {
+        size_t start = out.size();
+        out.append(4, '\0');
+        return start;
+    }
+
+    inline void endFrame(std::string& out, size_t start) {
+        uint32_t length = static_cast<uint32_t>(out.size() - start - 4);
+        for (int i = 0; i < 4; i++) out[start + i] = static_cast<char>(length >> (8 * i));
+    }
+}
@@ -0,0 +1,433 @@
+// minesweeper-gamed: hosts many independent games for programs that play
+// them, over a Unix domain socket or loopback TCP.
+//
+// Clients speak the protocol in gameprotocol.h. Each game is a bare Board
+// with no scores or history attached, just under 600 bytes at Expert size
+// counting its slot in the game table, which reuses freed slots. A single
+// thread serves every connection with epoll, answering each pipelined
+// request in turn and writing the replies back in as few send() calls as
+// the socket allows.
+#include "board.h"
+#include "gameprotocol.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    volatile sig_atomic_t stopRequested = 0;
+
+    void requestStop(int) {
+        stopRequested = 1;
+    }
+
+    // A client that stops reading its replies is dropped once this much
+    // is waiting for it
+    const size_t MAX_PENDING_OUTPUT = 64 << 20;
+
+    struct Client {
+        int fd;
+        uint64_t serial;              // Owner tag for its games; fds get reused
+        bool wantsWrite = false;      // EPOLLOUT is registered
+        std::string input;
+        std::string output;
+    };
+
+    class Server {
+    public:
+        ~Server() {
+            for (const auto& entry : clients) {
+                close(entry.first);
+            }
+            if (listener >= 0) {
+                close(listener);
+                if (!socketPath.empty()) unlink(socketPath.c_str());
+            }
+            if (epoll >= 0) close(epoll);
+        }
+
+        bool listenUnix(const std::string& path);
+        bool listenTcp(int port);
+        void run();
+
+    private:
+        bool startListening();
+        void acceptClients();
+        bool readFrom(Client& client);
+        bool writeTo(Client& client);
+        void handle(Client& client, const char* request, size_t length);
+        void closeClient(int fd);
+
+        uint32_t newGame(const Client& client, const Board& board);
+        Board* game(const Client& client, uint32_t id);
+        void endGame(uint32_t id);
+        static uint8_t cellCode(const Board& board, int row, int col);
+
+        int epoll = -1;
+        int listener = -1;
+        bool tcp = false;
+        std::string socketPath;
+        std::unordered_map<int, Client> clients;
+        uint64_t nextSerial = 1;
+
+        // Game table; a slot with owner 0 is free and listed in freeSlots
+        std::vector<Board> boards;
+        std::vector<uint64_t> owners;
+        std::vector<uint32_t> freeSlots;
+
+        std::vector<int> changes;  // Shared change log for the move in hand
+        std::mt19937 seeds{std::random_device{}()};
+    };
+
+    bool Server::listenUnix(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            fprintf(stderr, "Socket path too long: %s\n", path.c_str());
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        // A socket file nobody answers on is left over from a crash
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe >= 0) {
+            bool live = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            close(probe);
+            if (live) {
+                fprintf(stderr, "Another server is already listening on %s\n", path.c_str());
+                return false;
+            }
+        }
+        unlink(path.c_str());
+
+        listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        if (listener < 0 ||
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            perror("minesweeper-gamed");
+            return false;
+        }
+        socketPath = path;
+        return startListening();
+    }
+
+    // Loopback only; there is no authentication
+    bool Server::listenTcp(int port) {
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(static_cast<uint16_t>(port));
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        listener = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        int reuse = 1;
+        if (listener < 0 ||
+            setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+            perror("minesweeper-gamed");
+            return false;
+        }
+        tcp = true;
+        return startListening();
+    }
+
+    bool Server::startListening() {
+        epoll = epoll_create1(0);
+        epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = listener;
+        if (::listen(listener, SOMAXCONN) != 0 || epoll < 0 ||
+            epoll_ctl(epoll, EPOLL_CTL_ADD, listener, &event) != 0) {
+            perror("minesweeper-gamed");
+            return false;
+        }
+        return true;
+    }
+
+    void Server::run() {
+        epoll_event events[256];
+        while (!stopRequested) {
+            int ready = epoll_wait(epoll, events, 256, -1);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait");
+                return;
+            }
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listener) {
+                    acceptClients();
+                    continue;
+                }
+                auto found = clients.find(fd);
+                if (found == clients.end()) continue;
+                Client& client = found->second;
+
+                bool open = true;
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    open = readFrom(client);
+                }
+                if (open && !client.output.empty()) {
+                    open = writeTo(client);
+                }
+                if (open && client.output.empty() == client.wantsWrite) {
+                    // Only ask for EPOLLOUT while replies are held back
+                    client.wantsWrite = !client.output.empty();
+                    epoll_event change = {};
+                    change.events = client.wantsWrite ? EPOLLIN | EPOLLOUT : EPOLLIN;
+                    change.data.fd = fd;
+                    epoll_ctl(epoll, EPOLL_CTL_MOD, fd, &change);
+                }
+                if (!open) {
+                    closeClient(fd);
+                }
+            }
+        }
+    }
+
+    void Server::acceptClients() {
+        for (;;) {
+            int fd = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+            if (fd < 0) return;
+            if (tcp) {
+                int on = 1;
+                setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+                close(fd);
+                continue;
+            }
+            Client client;
+            client.fd = fd;
+            client.serial = nextSerial++;
+            clients.emplace(fd, std::move(client));
+        }
+    }
+
+    void Server::closeClient(int fd) {
+        auto found = clients.find(fd);
+        if (found == clients.end()) return;
+        // Disconnects are rare next to moves, so rather than keep a list
+        // of games per client the table is searched
+        for (uint32_t id = 0; id < owners.size(); id++) {
+            if (owners[id] == found->second.serial) {
+                endGame(id);
+            }
+        }
+        close(fd);
+        clients.erase(found);
+    }
+
+    // Reads what is available and answers every complete frame. Returns
+    // false once the client has gone or broken the protocol.
+    bool Server::readFrom(Client& client) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                client.input.append(buffer, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+
+        size_t consumed = 0;
+        while (client.input.size() - consumed >= 4) {
+            uint32_t length = GameProtocol::get(client.input.data() + consumed, 4);
+            if (length == 0 || length > GameProtocol::MAX_FRAME) return false;
+            if (client.input.size() - consumed - 4 < length) break;
+            handle(client, client.input.data() + consumed + 4, length);
+            consumed += 4 + length;
+        }
+        client.input.erase(0, consumed);
+        return client.output.size() <= MAX_PENDING_OUTPUT;
+    }
+
+    bool Server::writeTo(Client& client) {
+        size_t sent = 0;
+        while (sent < client.output.size()) {
+            ssize_t n = send(client.fd, client.output.data() + sent,
+                             client.output.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        client.output.erase(0, sent);
+        return true;
+    }
+
+    void Server::handle(Client& client, const char* request, size_t length) {
+        using namespace GameProtocol;
+        std::string& out = client.output;
+        size_t frame = beginFrame(out);
+        uint8_t opcode = static_cast<uint8_t>(request[0]);
+
+        if (opcode == NEW && length == 13) {
+            int width = get(request + 1, 2);
+            int height = get(request + 3, 2);
+            int mines = get(request + 5, 4);
+            uint32_t seed = get(request + 9, 4);
+            if (width < 5 || width > MAX_SIDE || height < 5 || height > MAX_SIDE ||
+                mines < 1 || mines > width * height - 9) {
+                putU8(out, BAD_REQUEST);
+            } else {
+                if (seed == RANDOM_SEED) {
+                    seed = seeds() & 0x7FFFFFFF;
+                }
+                Board board(width, height, mines, static_cast<int>(seed & 0x7FFFFFFF));
+                uint32_t id = newGame(client, board);
+                putU8(out, OK);
+                putU32(out, id);
+                putU32(out, static_cast<uint32_t>(board.seed()));
+            }
+        } else if (opcode == MOVE && length == 10) {
+            Board* board = game(client, get(request + 1, 4));
+            uint8_t move = static_cast<uint8_t>(request[5]);
+            int row = get(request + 6, 2);
+            int col = get(request + 8, 2);
+            if (!board) {
+                putU8(out, NO_GAME);
+            } else if (move > CHORD || !board->contains(row, col)) {
+                putU8(out, BAD_REQUEST);
+            } else {
+                changes.clear();
+                board->trackChanges(&changes);
+                if (move == REVEAL) {
+                    board->reveal(row, col);
+                } else if (move == FLAG) {
+                    board->toggleFlag(row, col);
+                } else {
+                    board->chord(row, col);
+                }
+                board->trackChanges(nullptr);
+
+                putU8(out, OK);
+                putU8(out, static_cast<uint8_t>(board->status()));
+                putU32(out, static_cast<uint32_t>(changes.size()));
+                int width = board->width();
+                for (int index : changes) {
+                    putU16(out, static_cast<uint16_t>(index / width));
+                    putU16(out, static_cast<uint16_t>(index % width));
+                    putU8(out, cellCode(*board, index / width, index % width));
+                }
+            }
+        } else if (opcode == STATE && length == 5) {
+            Board* board = game(client, get(request + 1, 4));
+            if (!board) {
+                putU8(out, NO_GAME);
+            } else {
+                putU8(out, OK);
+                putU8(out, static_cast<uint8_t>(board->status()));
+                putU16(out, static_cast<uint16_t>(board->width()));
+                putU16(out, static_cast<uint16_t>(board->height()));
+                for (int row = 0; row < board->height(); row++) {
+                    for (int col = 0; col < board->width(); col++) {
+                        putU8(out, cellCode(*board, row, col));
+                    }
+                }
+            }
+        } else if (opcode == CLOSE && length == 5) {
+            uint32_t id = get(request + 1, 4);
+            if (!game(client, id)) {
+                putU8(out, NO_GAME);
+            } else {
+                endGame(id);
+                putU8(out, OK);
+            }
+        } else {
+            putU8(out, BAD_REQUEST);
+        }
+        endFrame(out, frame);
+    }
+
+    uint32_t Server::newGame(const Client& client, const Board& board) {
+        uint32_t id;
+        if (!freeSlots.empty()) {
+            id = freeSlots.back();
+            freeSlots.pop_back();
+            boards[id] = board;
+        } else {
+            id = static_cast<uint32_t>(boards.size());
+            boards.push_back(board);
+            owners.push_back(0);
+        }
+        owners[id] = client.serial;
+        return id;
+    }
+
+    Board* Server::game(const Client& client, uint32_t id) {
+        if (id >= owners.size() || owners[id] != client.serial) return nullptr;
+        return &boards[id];
+    }
+
+    // Frees the cells at once; the slot itself is reused by the next game
+    void Server::endGame(uint32_t id) {
+        boards[id] = Board();
+        owners[id] = 0;
+        freeSlots.push_back(id);
+    }
+
+    uint8_t Server::cellCode(const Board& board, int row, int col) {
+        if (board.isFlagged(row, col)) return GameProtocol::FLAGGED;
+        if (!board.isRevealed(row, col)) return GameProtocol::HIDDEN;
+        if (board.isMine(row, col)) return GameProtocol::MINE;
+        return static_cast<uint8_t>(board.adjacentMines(row, col));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string socketPath = GameProtocol::defaultSocket();
+    int port = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else if (strcmp(argv[i], "--tcp") == 0 && i + 1 < argc) {
+            port = atoi(argv[++i]);
+        } else {
+            fprintf(stderr, "Usage: %s [--socket PATH | --tcp PORT]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (port <= 0 && socketPath.empty()) {
+        fprintf(stderr, "XDG_RUNTIME_DIR is not set; pass --socket PATH or --tcp PORT\n");
+        return 1;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = requestStop;  // No SA_RESTART, so epoll_wait() wakes up
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    Server server;
+    if (port > 0 ? !server.listenTcp(port) : !server.listenUnix(socketPath)) {
+        return 1;
+    }
+    if (port > 0) {
+        printf("minesweeper-gamed: listening on 127.0.0.1:%d\n", port);
+    } else {
+        printf("minesweeper-gamed: listening on %s\n", socketPath.c_str());
+    }
+    fflush(stdout);
+    server.run();
+    return 0;
+}
@@ -0,0 +1,388 @@
+// minesweeper-loadgen: drives minesweeper-gamed with many concurrent games
+// and reports move latency and throughput.
+//
+// Every connection opens its share of the games, then keeps a fixed number
+// of requests in flight, each a move in a random game at a random cell the
+// client still sees as hidden. A finished game is closed and replaced, so
+// the number of live games stays constant. Latency is measured from the
+// moment a request is queued for sending until its reply is parsed, which
+// includes any time it waits behind earlier pipelined requests.
+#include "gameprotocol.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <string>
+#include <vector>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    struct Options {
+        std::string socketPath = GameProtocol::defaultSocket();
+        int port = 0;
+        int connections = 4;
+        int games = 1000;  // In total, split across the connections
+        int depth = 32;    // Requests in flight per connection
+        double seconds = 5;
+        int width = 30;
+        int height = 16;
+        int mines = 99;
+    };
+
+    struct Game {
+        uint32_t id = 0;
+        bool live = false;           // False between a CLOSE and the NEW reply
+        std::vector<uint8_t> cells;  // As the replies have described them
+    };
+
+    struct Pending {
+        uint8_t opcode;
+        uint32_t game;  // Index into Connection::games
+        std::chrono::steady_clock::time_point sent;
+    };
+
+    struct Connection {
+        int fd = -1;
+        std::vector<Game> games;
+        std::deque<Pending> pending;
+        std::string input;
+        std::string output;
+    };
+
+    struct Totals {
+        std::vector<uint32_t> latencies;  // Nanoseconds, one per move
+        long gamesWon = 0;
+        long gamesLost = 0;
+        long errors = 0;
+    };
+
+    int connectTo(const Options& options) {
+        int fd;
+        if (options.port > 0) {
+            sockaddr_in address = {};
+            address.sin_family = AF_INET;
+            address.sin_port = htons(static_cast<uint16_t>(options.port));
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if (fd >= 0) close(fd);
+                return -1;
+            }
+            int on = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+        } else {
+            sockaddr_un address = {};
+            address.sun_family = AF_UNIX;
+            strncpy(address.sun_path, options.socketPath.c_str(), sizeof(address.sun_path) - 1);
+            fd = socket(AF_UNIX, SOCK_STREAM, 0);
+            if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+                if (fd >= 0) close(fd);
+                return -1;
+            }
+        }
+        // Blocking connect, then non-blocking traffic
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        return fd;
+    }
+
+    class LoadGenerator {
+    public:
+        explicit LoadGenerator(const Options& options) : options(options) {}
+        int run();
+
+    private:
+        void sendNew(Connection& connection, uint32_t game);
+        bool sendMove(Connection& connection);
+        void fill(Connection& connection);
+        bool flush(Connection& connection);
+        bool receive(Connection& connection);
+        bool handleReply(Connection& connection, const char* reply, size_t length);
+        void report(double elapsed) const;
+
+        Options options;
+        std::vector<Connection> connections;
+        Totals totals;
+        std::mt19937 random{12345};
+        bool stopping = false;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    void LoadGenerator::sendNew(Connection& connection, uint32_t game) {
+        using namespace GameProtocol;
+        size_t frame = beginFrame(connection.output);
+        putU8(connection.output, NEW);
+        putU16(connection.output, static_cast<uint16_t>(options.width));
+        putU16(connection.output, static_cast<uint16_t>(options.height));
+        putU32(connection.output, static_cast<uint32_t>(options.mines));
+        putU32(connection.output, random() & 0x7FFFFFFF);
+        endFrame(connection.output, frame);
+        connection.pending.push_back(Pending{NEW, game, std::chrono::steady_clock::now()});
+    }
+
+    // A reveal, or now and then a flag, in a live game. Flags are taken
+    // off again too, or a game whose safe cells all got flagged would never
+    // end. False when no game is ready for a move.
+    bool LoadGenerator::sendMove(Connection& connection) {
+        using namespace GameProtocol;
+        size_t count = connection.games.size();
+        size_t start = random() % count;
+        for (size_t i = 0; i < count; i++) {
+            uint32_t index = static_cast<uint32_t>((start + i) % count);
+            Game& game = connection.games[index];
+            if (!game.live) continue;
+
+            int cell = -1;
+            for (int tries = 0; tries < 64 && cell < 0; tries++) {
+                int candidate = random() % game.cells.size();
+                if (game.cells[candidate] == HIDDEN || game.cells[candidate] == FLAGGED) {
+                    cell = candidate;
+                }
+            }
+            if (cell < 0) continue;
+            uint8_t move = game.cells[cell] == FLAGGED || random() % 10 == 0 ? FLAG : REVEAL;
+
+            size_t frame = beginFrame(connection.output);
+            putU8(connection.output, MOVE);
+            putU32(connection.output, game.id);
+            putU8(connection.output, move);
+            putU16(connection.output, static_cast<uint16_t>(cell / options.width));
+            putU16(connection.output, static_cast<uint16_t>(cell % options.width));
+            endFrame(connection.output, frame);
+            connection.pending.push_back(Pending{MOVE, index, std::chrono::steady_clock::now()});
+            return true;
+        }
+        return false;
+    }
+
+    void LoadGenerator::fill(Connection& connection) {
+        while (!stopping && connection.pending.size() < static_cast<size_t>(options.depth)) {
+            if (!sendMove(connection)) break;
+        }
+    }
+
+    bool LoadGenerator::flush(Connection& connection) {
+        size_t sent = 0;
+        while (sent < connection.output.size()) {
+            ssize_t n = send(connection.fd, connection.output.data() + sent,
+                             connection.output.size() - sent, MSG_NOSIGNAL);
+            if (n > 0) {
+                sent += n;
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+        connection.output.erase(0, sent);
+        return true;
+    }
+
+    bool LoadGenerator::receive(Connection& connection) {
+        char buffer[65536];
+        for (;;) {
+            ssize_t n = recv(connection.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                connection.input.append(buffer, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            fprintf(stderr, "Server closed the connection\n");
+            return false;
+        }
+
+        size_t consumed = 0;
+        while (connection.input.size() - consumed >= 4) {
+            uint32_t length = GameProtocol::get(connection.input.data() + consumed, 4);
+            if (connection.input.size() - consumed - 4 < length) break;
+            if (!handleReply(connection, connection.input.data() + consumed + 4, length)) {
+                return false;
+            }
+            consumed += 4 + length;
+        }
+        connection.input.erase(0, consumed);
+        return true;
+    }
+
+    bool LoadGenerator::handleReply(Connection& connection, const char* reply, size_t length) {
+        using namespace GameProtocol;
+        if (connection.pending.empty() || length < 1) {
+            fprintf(stderr, "Unexpected reply\n");
+            return false;
+        }
+        Pending request = connection.pending.front();
+        connection.pending.pop_front();
+        Game& game = connection.games[request.game];
+        if (static_cast<uint8_t>(reply[0]) != OK) {
+            totals.errors++;
+            return true;
+        }
+
+        if (request.opcode == NEW && length == 9) {
+            game.id = get(reply + 1, 4);
+            game.live = true;
+            game.cells.assign(static_cast<size_t>(options.width) * options.height, HIDDEN);
+        } else if (request.opcode == MOVE && length >= 6) {
+            auto latency = std::chrono::steady_clock::now() - request.sent;
+            totals.latencies.push_back(static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count()));
+
+            uint8_t status = static_cast<uint8_t>(reply[1]);
+            uint32_t count = get(reply + 2, 4);
+            if (length != 6 + static_cast<size_t>(count) * 5) {
+                fprintf(stderr, "Malformed move reply\n");
+                return false;
+            }
+            for (uint32_t i = 0; i < count; i++) {
+                const char* change = reply + 6 + i * 5;
+                int row = get(change, 2);
+                int col = get(change + 2, 2);
+                game.cells[static_cast<size_t>(row) * options.width + col] =
+                    static_cast<uint8_t>(change[4]);
+            }
+            // Moves already in flight to a finished game come back
+            // unchanged; the game is replaced once, on the first of them
+            if (status != PLAYING && game.live) {
+                (status == WON ? totals.gamesWon : totals.gamesLost)++;
+                game.live = false;
+                size_t frame = beginFrame(connection.output);
+                putU8(connection.output, CLOSE);
+                putU32(connection.output, game.id);
+                endFrame(connection.output, frame);
+                connection.pending.push_back(Pending{CLOSE, request.game, std::chrono::steady_clock::now()});
+                if (!stopping) sendNew(connection, request.game);
+            }
+        }
+        return true;
+    }
+
+    int LoadGenerator::run() {
+        int epoll = epoll_create1(0);
+        connections.resize(options.connections);
+        for (int i = 0; i < options.connections; i++) {
+            Connection& connection = connections[i];
+            connection.fd = connectTo(options);
+            if (connection.fd < 0) {
+                perror("minesweeper-loadgen: connect");
+                return 1;
+            }
+            epoll_event event = {};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLET;
+            event.data.u32 = static_cast<uint32_t>(i);
+            epoll_ctl(epoll, EPOLL_CTL_ADD, connection.fd, &event);
+
+            int share = options.games / options.connections + (i < options.games % options.connections);
+            connection.games.resize(std::max(share, 1));
+            for (uint32_t game = 0; game < connection.games.size(); game++) {
+                sendNew(connection, game);
+            }
+        }
+
+        started = std::chrono::steady_clock::now();
+        auto deadline = started + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                      std::chrono::duration<double>(options.seconds));
+        epoll_event events[64];
+        for (;;) {
+            bool idle = true;
+            for (Connection& connection : connections) {
+                fill(connection);
+                if (!flush(connection)) return 1;
+                if (!connection.pending.empty()) idle = false;
+            }
+            if (stopping && idle) break;
+
+            int ready = epoll_wait(epoll, events, 64, 100);
+            for (int i = 0; i < ready; i++) {
+                if ((events[i].events & EPOLLIN) && !receive(connections[events[i].data.u32])) {
+                    return 1;
+                }
+            }
+            if (!stopping && std::chrono::steady_clock::now() >= deadline) {
+                stopping = true;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - started;
+        report(elapsed.count());
+
+        for (Connection& connection : connections) {
+            close(connection.fd);
+        }
+        close(epoll);
+        return totals.errors == 0 ? 0 : 1;
+    }
+
+    void LoadGenerator::report(double elapsed) const {
+        std::vector<uint32_t> sorted = totals.latencies;
+        std::sort(sorted.begin(), sorted.end());
+        auto quantile = [&](double q) {
+            if (sorted.empty()) return 0.0;
+            size_t index = std::min(sorted.size() - 1, static_cast<size_t>(q * sorted.size()));
+            return sorted[index] / 1000.0;
+        };
+        printf("%d connections, %d games, %d in flight per connection, %dx%d with %d mines\n",
+               options.connections, options.games, options.depth, options.width,
+               options.height, options.mines);
+        printf("moves: %zu in %.2fs, %.0f moves/s\n", sorted.size(), elapsed,
+               sorted.size() / elapsed);
+        printf("latency: p50 %.1fus, p99 %.1fus, max %.1fus\n", quantile(0.5),
+               quantile(0.99), quantile(1.0));
+        printf("games finished: %ld won, %ld lost; %ld errors\n", totals.gamesWon,
+               totals.gamesLost, totals.errors);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; i++) {
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!value) {
+            // Every option takes a value
+        } else if (strcmp(argv[i], "--socket") == 0) {
+            options.socketPath = value;
+        } else if (strcmp(argv[i], "--tcp") == 0) {
+            options.port = atoi(value);
+        } else if (strcmp(argv[i], "--connections") == 0) {
+            options.connections = atoi(value);
+        } else if (strcmp(argv[i], "--games") == 0) {
+            options.games = atoi(value);
+        } else if (strcmp(argv[i], "--depth") == 0) {
+            options.depth = atoi(value);
+        } else if (strcmp(argv[i], "--seconds") == 0) {
+            options.seconds = atof(value);
+        } else if (strcmp(argv[i], "--board") == 0 &&
+                   sscanf(value, "%dx%dx%d", &options.width, &options.height, &options.mines) == 3) {
+        } else {
+            value = nullptr;
+        }
+        if (!value || options.connections < 1 || options.games < 1 || options.depth < 1 ||
+            options.width < 5 || options.width > GameProtocol::MAX_SIDE || options.height < 5 ||
+            options.height > GameProtocol::MAX_SIDE || options.mines < 1 ||
+            options.mines > options.width * options.height - 9) {
+            fprintf(stderr,
+                    "Usage: %s [--socket PATH | --tcp PORT] [--connections N] [--games N]\n"
+                    "          [--depth N] [--seconds S] [--board WIDTHxHEIGHTxMINES]\n",
+                    argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (options.port <= 0 && options.socketPath.empty()) {
+        fprintf(stderr, "XDG_RUNTIME_DIR is not set; pass --socket PATH or --tcp PORT\n");
+        return 1;
+    }
+
+    LoadGenerator generator(options);
+    return generator.run();
+}
@@ -52,7 +52,8 @@ mkdir -p "$BUILD_DIR"
 # Compile the application if no exe path provided
 if [ -z "$EXE_PATH" ]; then
     echo "Compiling minesweeper..."
-    x86_64-w64-mingw32-gcc -o "$BUILD_DIR/minesweeper_gtk.exe" gtk_minesweeper.cpp highscores.cpp `mingw64-pkg-config --cflags gtk+-3.0 --libs gtk+-3.0` -lstdc++
+    glib-compile-resources --target="$BUILD_DIR/resources.c" --generate-source minesweeper.gresource.xml || exit 1
+    x86_64-w64-mingw32-gcc -o "$BUILD_DIR/minesweeper_gtk.exe" gtk_minesweeper.cpp minesweeper.cpp highscores.cpp history.cpp minimap.cpp replay.cpp "$BUILD_DIR/resources.c" `mingw64-pkg-config --cflags gtk+-3.0 --libs gtk+-3.0` -lstdc++
     
     if [ $? -ne 0 ]; then
         echo "Compilation failed!"
@@ -1,216 +1,18 @@
 #include "gtk_minesweeper.h"
-#include <sstream>
-#include <iomanip>
-#include <random>
 #include <gtk/gtk.h>
 #include <gdk/gdk.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstring>
-
-const char* GTKMinesweeper::FLAG_BASE64 = R"(iVBORw0KGgoAAAANSUhEUgAAACAAAAAgBAMAAACBVGfHAAAABGdBTUEAALGPC/xhBQAAAAFzUkdCAdn
-JLH8AAAAgY0hSTQAAeiYAAICEAAD6AAAAgOgAAHUwAADqYAAAOpgAABdwnLpRPAAAACFQTFRFAAAA/2Z
-mAAAA////mTMzzMzMzGZmZjMzmWYzMwAA/8xmaoi8KgAAAAF0Uk5TAEDm2GYAAABdSURBVCjPY2DABpQ
-U0AS6GggJKCkooepSVkkUTJnEwMAEE1VWFBQUFHOf7oIiAAIDLaDmXu6GIqAEdPaUREERuACYgeRBZfQ
-AGqwCSmixwhQaGhqEIgBUocSAEwAAjwQWTza+izoAAAAASUVORK5CYII=)";
-
-const char* GTKMinesweeper::BOMB_BASE64 = R"(iVBORw0KGgoAAAANSUhEUgAAACAAAAAgBAMAAACBVGfHAAAABGdBTUEAALGPC/xhBQAAAAFzUkdCAd
-nJLH8AAAAgY0hSTQAAeiYAAICEAAD6AAAAgOgAAHUwAADqYAAAOpgAABdwnLpRPAAAACFQTFRFAAAA
-gwMTcwoRqBIlgTE0yyk14kFE21NWqnN1z5ye////XulGdQAAAAF0Uk5TAEDm2GYAAADbSURBVCjPbdK9
-DoIwEAfwQ/lYKeEBsOEFTF10qm9AQqpxc7GzizAbN1cmeALCU0rLtUVClza/XPMvdwCsrNocfK63UBYI
-JNdb5YBmukA+Ec40/4cdpRMI2DK2B49ogDq8RKJkjHgEY6AQGjg3+dEExL4sQLAVL4TYwAMhNSAQkiW4
-iu/QsOPQO+hGOA29u3JrS3Zo3+k8tpvHavjMQKUMzQLasSIDJ+odqftYUJD6WFFVoghGiEmy4VMLrxCM
-LYx9Yppc2K6rnkZS3u1c8sXk6BRi54Lg1mbtV/gBxfI7i3nTTAoAAAAASUVORK5CYII=)";
-
-const char* GTKMinesweeper::REVEALED_BASE64 = R"(iVBORw0KGgoAAAANSUhEUgAAACAAAAAgAQMAAABJtOi3AAAABGdBTUEAALGPC/xhBQAAAAFzUkdCAdn
-JLH8AAAAgY0hSTQAAeiYAAICEAAD6AAAAgOgAAHUwAADqYAAAOpgAABdwnLpRPAAAAAZQTFRFAAAAIx8
-gaVhvIAAAAAF0Uk5TAEDm2GYAAABWSURBVAjXY2DADRpghEITkDBoAxICLDBJ/g9AwoIPSCQcBin72MD
-AyPDDgYGJ44cCAwv/DwMGNhDBzP8jgYGx/cMBBobjD4FmFbQDFcvZAAn2BwxEAADI2BObaHDmJQAAAAB
-JRU5ErkJggg==)";
-
-const char* GTKMinesweeper::ICON_BASE64 = R"(AAABAAEAICAQAAEABADoAgAAFgAAACgAAAAgAAAAQAAAAAEABAAAAAAAAAIAAAAAAAAAAAAAEAAAABAA
-AABKNaUAhl1FAE5gdQDkljwAjXu8AHVy4AAfgN8AsaKMAGmwzgDt6NwAAAAAAAAAAAAAAAAAAAAAAAAAAAA
-AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
-AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAmZmZmZmZmZmZmZmZmZmZmZmZd3d3
-d3d3d3d3d3d3eZmZcREREQAAACAAACEREReZmREUERBQAABmZmZhMzMzeZdxBgEQUAAAhmZmYXd3EXmXeI
-ZmEAVVAIaGZmF3d3F5l3KIghBEBVCGKIZhmZlxeZdxdxEQWZQAhmJmZ3d3EXmXd3dxFFBQUIZmZmcXdxF5
-l3d3cRd0d3R5d3InF5cReZd3mXd4SIgABFSEhxFxEXmXl3d3eIiCEzMUiIcXdxF5l3mXmXKIEzMzMUiHF3
-cReZczNzM4gjMxEzMVh3FxcXmXF3d3coF3d3czNIAAAAB5l3d3d3gnd3d3czKAUAAAeZeWImB4h3d3d3M4
-hQF3EHmXl2ZgcoGZl3mTGIVHd3B5l3hmJ3iCmZmXMyiFCZlweZeYYodygilxETKIhVAUAHmXlyd3eIICeX
-GIiIURVVB5l5mZmXdIIndBiISXdERAeZdWZmZRERERIhF3EAAAAHmXZgZmYXERESIgd3VQAAB5l4BoZmd3
-cRF3Zmd1AFAAeZeAiYBnd3cRcImAdVSUUHmXiIiIZ3d3EXdoh3UERAB5mYiAiGd5l3F3cnd1VQVQmZl4iI
-iHmZmXeZmZdEREVJmZl3d3d3d3d3d3d3d3d3mZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZmZkA
-AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA
-AAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAAA==)";
-
-
-// GameTimer implementation
-void GameTimer::start() {
-    startTime = std::chrono::steady_clock::now();
-    running = true;
-}
-
-void GameTimer::stop() {
-    if (running) {
-        auto now = std::chrono::steady_clock::now();
-        elapsedSeconds = std::chrono::duration_cast<std::chrono::seconds>(
-            now - startTime).count();
-        running = false;
-    }
-}
-
-int GameTimer::getElapsedSeconds() const {
-    if (running) {
-        auto now = std::chrono::steady_clock::now();
-        return std::chrono::duration_cast<std::chrono::seconds>(
-            now - startTime).count();
-    }
-    return elapsedSeconds;
-}
-
-std::string GameTimer::getTimeString() const {
-    int totalSeconds = getElapsedSeconds();
-    int minutes = totalSeconds / 60;
-    int seconds = totalSeconds % 60;
-    std::stringstream ss;
-    ss << std::setfill('0') << std::setw(2) << minutes 
-       << ":" << std::setfill('0') << std::setw(2) << seconds;
-    return ss.str();
-}
-
-// Minesweeper implementation
-Minesweeper::Minesweeper() 
-    : height(9)
-    , width(9)
-    , mines(10)
-    , firstMove(true)
-    , gameOver(false)
-    , won(false) {
-    reset();
-}
-
-void Minesweeper::setDifficulty(Difficulty diff) {
-    const DifficultySettings& settings = DIFFICULTY_SETTINGS[static_cast<int>(diff)];
-    height = settings.height;
-    width = settings.width;
-    mines = settings.mines;
-    reset();
-}
-
-void Minesweeper::reset() {
-    minefield = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-    revealed = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-    flagged = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
-    gameOver = false;
-    won = false;
-    firstMove = true;
-    timer.stop();
-}
-
-void Minesweeper::initializeMinefield(int firstY, int firstX, int seed) {
-    std::mt19937 gen;
-    unsigned int finalSeed;
-    
-    if (seed < 0) {
-        std::random_device rd;
-        finalSeed = rd();
-    } else {
-        finalSeed = static_cast<unsigned int>(seed);
-    }
-    currentSeed=finalSeed;
-    gen.seed(finalSeed);
-    
-    std::uniform_int_distribution<> disH(0, height - 1);
-    std::uniform_int_distribution<> disW(0, width - 1);
-    
-    int placedMines = 0;
-    while (placedMines < mines) {
-        int y = disH(gen);
-        int x = disW(gen);
-        if (!minefield[y][x] && 
-            (abs(y - firstY) > 1 || abs(x - firstX) > 1)) {
-            minefield[y][x] = true;
-            placedMines++;
-        }
-    }
-}
-
-int Minesweeper::countAdjacentMines(int y, int x) {
-    int count = 0;
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            int newY = y + dy;
-            int newX = x + dx;
-            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-                if (minefield[newY][newX]) count++;
-            }
-        }
-    }
-    return count;
-}
-
-void Minesweeper::revealCell(int y, int x) {
-    if (y < 0 || y >= height || x < 0 || x >= width || 
-        revealed[y][x] || flagged[y][x]) 
-        return;
-
-    revealed[y][x] = true;
-    
-    if (countAdjacentMines(y, x) == 0) {
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                revealCell(y + dy, x + dx);
-            }
-        }
-    }
-}
-
-void Minesweeper::revealAllMines() {
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            if (minefield[y][x]) revealed[y][x] = true;
-        }
-    }
-}
-
-bool Minesweeper::checkWin() {
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            if (!minefield[y][x] && !revealed[y][x]) {
-                return false;
-            }
-        }
-    }
-    return true;
-}
-
-bool Minesweeper::isHighScore(int time, const std::string& difficulty) {
-    // Only check high scores for standard difficulty levels
-    if ((width == 9 && height == 9 && mines == 10) ||
-        (width == 16 && height == 16 && mines == 40) ||
-        (width == 30 && height == 16 && mines == 99)) {
-        return highscores.isHighScore(time, difficulty);
-    }
-    // Custom games always return false for high scores
-    return false;
-}
-void Minesweeper::saveHighscore() {
-    std::string difficultyStr;
-    switch (width) {
-        case 9: difficultyStr = "Easy"; break;
-        case 16: difficultyStr = "Medium"; break;
-        case 30: difficultyStr = "Hard"; break;
-        default: return;
-    }
-    
-    Score score;
-    score.name = playerName;
-    score.time = timer.getElapsedSeconds();
-    score.difficulty = difficultyStr;
-    highscores.addScore(score);
-}
+#include <stdexcept>
+#include <ctime>
 
 // Add these to gtk_minesweeper.cpp:
 
 void GTKMinesweeper::show_game_over_dialog() {
+    game->recordGame(GameOutcome::LOST);
+
     GtkWidget *dialog = gtk_message_dialog_new(
         GTK_WINDOW(window),
         GTK_DIALOG_MODAL,
@@ -228,16 +30,15 @@ void GTKMinesweeper::on_entry_activate(GtkEntry*, gpointer user_data) {
 }
 
 void GTKMinesweeper::show_win_dialog() {
-    int time = game->timer.getElapsedSeconds();
-    std::string difficulty;
-    switch(game->width) {
-        case 9: difficulty = "Easy"; break;
-        case 16: difficulty = "Medium"; break;
-        case 30: difficulty = "Hard"; break;
-        default: difficulty = "Custom"; break;
-    }
+    save_replay();
+
+    int timeMs = game->timer.getElapsedMillis();
+    BoardKey board = Highscores::packBoard(game->width, game->height, game->mines);
+    bool hasEarlierWins = game->history.winTimes(board) != nullptr;
+    int percentSlower = static_cast<int>(game->history.fractionSlower(board, timeMs) * 100);
+    game->recordGame(GameOutcome::WON);
     
-    if(game->isHighScore(time, difficulty)) {
+    if(game->isHighScore(timeMs)) {
         GtkWidget *dialog = gtk_dialog_new_with_buttons(
             "New High Score!",
             GTK_WINDOW(window),
@@ -273,6 +74,11 @@ void GTKMinesweeper::show_win_dialog() {
             GTK_MESSAGE_INFO,
             GTK_BUTTONS_OK,
             "Congratulations! You won!");
+        if(hasEarlierWins) {
+            gtk_message_dialog_format_secondary_text(GTK_MESSAGE_DIALOG(dialog),
+                "Time: %s\nFaster than %d%% of your earlier wins on this board.",
+                formatScoreTime(timeMs).c_str(), percentSlower);
+        }
             
         gtk_dialog_run(GTK_DIALOG(dialog));
         gtk_widget_destroy(dialog);
@@ -282,155 +88,401 @@ void GTKMinesweeper::show_win_dialog() {
 
 
 void GTKMinesweeper::update_all_cells() {
-    for(int i = 0; i < game->height; i++) {
-        for(int j = 0; j < game->width; j++) {
-            update_cell(i, j);
+    gtk_widget_queue_draw(board_area);
+}
+
+// Repaints just the cells the last action changed. A flood that opened a
+// large part of the view is cheaper to redraw in one go; cells scrolled
+// out of sight are clipped away by GTK.
+void GTKMinesweeper::update_changed_cells() {
+    std::vector<std::pair<int, int>>& changed = game->changedCells;
+    int visible_cols = gtk_widget_get_allocated_width(board_area) / cell_size + 1;
+    int visible_rows = gtk_widget_get_allocated_height(board_area) / cell_size + 1;
+    if (changed.size() > static_cast<size_t>(visible_cols * visible_rows / 4)) {
+        update_all_cells();
+    } else {
+        for (const auto& cell : changed) {
+            update_cell(cell.first, cell.second);
         }
     }
+    update_minimap(changed);
+    changed.clear();
 }
 
 void GTKMinesweeper::update_cell(int row, int col) {
-    GtkWidget *button = buttons[row][col];
-    
-    // Remove any existing image first
-    gtk_button_set_image(GTK_BUTTON(button), nullptr);
-    
-    // Get and remove any existing label
-    GtkWidget *existing_child = gtk_bin_get_child(GTK_BIN(button));
-    if (existing_child) {
-        gtk_container_remove(GTK_CONTAINER(button), existing_child);
+    gtk_widget_queue_draw_area(board_area, board_x + col * cell_size, board_y + row * cell_size,
+                               cell_size, cell_size);
+}
+
+// Picks the cell size (the largest that fits, unless the user has zoomed)
+// and sizes the scrollbars to match. Runs on resize, zoom and new boards,
+// never per frame.
+void GTKMinesweeper::update_layout() {
+    int area_width = gtk_widget_get_allocated_width(board_area);
+    int area_height = gtk_widget_get_allocated_height(board_area);
+    if (area_width <= 1 || area_height <= 1) {
+        return;  // Not allocated yet; size-allocate will call back
     }
-    
-    // Create style provider for the button
-    GtkCssProvider *button_provider = gtk_css_provider_new();
-    GtkStyleContext *button_context = gtk_widget_get_style_context(button);
-    
+    if (fit_to_view) {
+        int fit = std::min(area_width / game->width, area_height / game->height);
+        cell_size = std::max(MIN_CELL_SIZE, std::min(MAX_CELL_SIZE, fit));
+    }
+
+    int board_width = cell_size * game->width;
+    int board_height = cell_size * game->height;
+    bool scrolling = board_width > area_width || board_height > area_height;
+    if (gtk_widget_get_visible(hscrollbar) != scrolling) {
+        gtk_widget_set_visible(hscrollbar, scrolling);
+        gtk_widget_set_visible(vscrollbar, scrolling);
+        gtk_widget_set_visible(minimap_area, scrolling);
+    }
+    configure_adjustment(hadjustment, board_width, area_width);
+    configure_adjustment(vadjustment, board_height, area_height);
+    update_origin();
+}
+
+void GTKMinesweeper::configure_adjustment(GtkAdjustment *adjustment, int board_pixels,
+                                          int view_pixels) {
+    double upper = std::max(board_pixels, view_pixels);
+    double value = std::min(gtk_adjustment_get_value(adjustment), upper - view_pixels);
+    gtk_adjustment_configure(adjustment, std::max(0.0, value), 0, upper, cell_size,
+                             view_pixels * 0.9, view_pixels);
+}
+
+// A board smaller than the view is centred in it; a larger one starts
+// where the scrollbars say
+void GTKMinesweeper::update_origin() {
+    int area_width = gtk_widget_get_allocated_width(board_area);
+    int area_height = gtk_widget_get_allocated_height(board_area);
+    int board_width = cell_size * game->width;
+    int board_height = cell_size * game->height;
+    board_x = board_width <= area_width
+        ? (area_width - board_width) / 2
+        : -static_cast<int>(std::lround(gtk_adjustment_get_value(hadjustment)));
+    board_y = board_height <= area_height
+        ? (area_height - board_height) / 2
+        : -static_cast<int>(std::lround(gtk_adjustment_get_value(vadjustment)));
+}
+
+// Scales the cells by factor, keeping the board point under (x, y) where
+// it is on screen
+void GTKMinesweeper::zoom_at(double factor, double x, double y) {
+    int size = static_cast<int>(std::lround(cell_size * factor));
+    if (size == cell_size) {
+        size += factor > 1 ? 1 : -1;
+    }
+    size = std::max(MIN_CELL_SIZE, std::min(MAX_CELL_SIZE, size));
+    fit_to_view = false;
+    if (size == cell_size) {
+        return;
+    }
+
+    double board_px = x - board_x;
+    double board_py = y - board_y;
+    double ratio = static_cast<double>(size) / cell_size;
+    cell_size = size;
+    update_layout();
+    gtk_adjustment_set_value(hadjustment, board_px * ratio - x);
+    gtk_adjustment_set_value(vadjustment, board_py * ratio - y);
+    update_origin();
+    update_all_cells();
+}
+
+void GTKMinesweeper::zoom_to_fit() {
+    fit_to_view = true;
+    update_layout();
+    update_all_cells();
+}
+
+// Shows the finest pyramid level that fits MINIMAP_SIZE, enlarged by a
+// whole factor when the board is small
+void GTKMinesweeper::reset_minimap() {
+    minimap.reset(game->width, game->height);
+    minimap_level = minimap.levelFitting(MINIMAP_SIZE, MINIMAP_SIZE);
+    int width = minimap.width(minimap_level);
+    int height = minimap.height(minimap_level);
+    minimap_zoom = std::max(1, MINIMAP_SIZE / std::max(width, height));
+
+    if (minimap_surface) {
+        cairo_surface_destroy(minimap_surface);
+    }
+    minimap_surface = cairo_image_surface_create_for_data(
+        reinterpret_cast<unsigned char*>(minimap.pixels(minimap_level)), CAIRO_FORMAT_ARGB32,
+        width, height, width * 4);
+    gtk_widget_set_size_request(minimap_area, width * minimap_zoom + 2, height * minimap_zoom + 2);
+    gtk_widget_queue_draw(minimap_area);
+}
+
+void GTKMinesweeper::update_minimap(const std::vector<std::pair<int, int>>& cells) {
+    if (cells.empty()) {
+        return;
+    }
+    cairo_surface_flush(minimap_surface);
+    for (const auto& cell : cells) {
+        int row = cell.first;
+        int col = cell.second;
+        MinimapPyramid::CellState state = MinimapPyramid::HIDDEN;
+        if (game->revealed[row][col]) {
+            state = game->minefield[row][col] ? MinimapPyramid::MINE : MinimapPyramid::OPEN;
+        } else if (game->flagged[row][col]) {
+            state = MinimapPyramid::FLAGGED;
+        }
+        minimap.set(row, col, state);
+    }
+    minimap.commit();
+    cairo_surface_mark_dirty(minimap_surface);
+    gtk_widget_queue_draw(minimap_area);
+}
+
+// Centres the view on the board position under (x, y) in the minimap
+void GTKMinesweeper::jump_to_minimap(double x, double y) {
+    double scale_x = static_cast<double>(minimap.width(minimap_level) * minimap_zoom) /
+                     (game->width * cell_size);
+    double scale_y = static_cast<double>(minimap.height(minimap_level) * minimap_zoom) /
+                     (game->height * cell_size);
+    gtk_adjustment_set_value(hadjustment, (x - 1) / scale_x -
+                             gtk_adjustment_get_page_size(hadjustment) / 2);
+    gtk_adjustment_set_value(vadjustment, (y - 1) / scale_y -
+                             gtk_adjustment_get_page_size(vadjustment) / 2);
+}
+
+bool GTKMinesweeper::cell_at(double x, double y, int &row, int &col) const {
+    if (x < board_x || y < board_y) {
+        return false;
+    }
+    col = static_cast<int>(x - board_x) / cell_size;
+    row = static_cast<int>(y - board_y) / cell_size;
+    return row < game->height && col < game->width;
+}
+
+int GTKMinesweeper::tile_for(int row, int col) const {
     if(game->revealed[row][col]) {
-        // Set the revealed cell background color to match Windows SystemColors::Control
-        const char* revealed_bg_css = "button { background: #F0F0F0; border: 1px solid #A0A0A0; }";
-        gtk_css_provider_load_from_data(button_provider, revealed_bg_css, -1, NULL);
-        gtk_style_context_add_provider(button_context,
-                                     GTK_STYLE_PROVIDER(button_provider),
-                                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-        
         if(game->minefield[row][col]) {
-            // Show mine
-            GtkWidget *image = gtk_image_new_from_pixbuf(bomb_pixbuf);
-            gtk_widget_show(image);
-            gtk_button_set_image(GTK_BUTTON(button), image);
+            return TILE_MINE;
+        }
+        return TILE_OPEN + game->countAdjacentMines(row, col);
+    }
+    if(game->flagged[row][col]) {
+        return TILE_FLAG;
+    }
+    return ghost.isRevealed(row, col) ? TILE_GHOST : TILE_HIDDEN;
+}
+
+void GTKMinesweeper::clear_tile_atlas() {
+    if (tile_atlas) {
+        cairo_surface_destroy(tile_atlas);
+        tile_atlas = nullptr;
+    }
+}
+
+// Renders every cell appearance side by side into one surface at the
+// current cell size. The surface is created at the monitor's scale
+// factor, so tiles stay sharp on HiDPI screens. Only a resize or a scale
+// change rebuilds it; drawing a cell is then a single blit.
+void GTKMinesweeper::build_tile_atlas() {
+    int scale = gtk_widget_get_scale_factor(board_area);
+    if (tile_atlas && atlas_cell_size == cell_size && atlas_scale == scale) {
+        return;
+    }
+    clear_tile_atlas();
+    tile_atlas = gdk_window_create_similar_image_surface(gtk_widget_get_window(board_area),
+                                                         CAIRO_FORMAT_ARGB32,
+                                                         TILE_COUNT * cell_size * scale,
+                                                         cell_size * scale, scale);
+    atlas_cell_size = cell_size;
+    atlas_scale = scale;
+
+    cairo_t *cr = cairo_create(tile_atlas);
+    for (int tile = 0; tile < TILE_COUNT; tile++) {
+        cairo_save(cr);
+        cairo_translate(cr, tile * cell_size, 0);
+        render_tile(cr, tile, cell_size);
+        cairo_restore(cr);
+    }
+    cairo_destroy(cr);
+}
+
+// Draws a pixbuf filling size x size at (x, y), resampled at whatever
+// resolution the target surface has
+static void paint_pixbuf(cairo_t *cr, GdkPixbuf *pixbuf, double x, double y, double size) {
+    if (!pixbuf || size <= 0) {
+        return;
+    }
+    cairo_save(cr);
+    cairo_translate(cr, x, y);
+    cairo_scale(cr, size / gdk_pixbuf_get_width(pixbuf), size / gdk_pixbuf_get_height(pixbuf));
+    gdk_cairo_set_source_pixbuf(cr, pixbuf, 0, 0);
+    cairo_paint(cr);
+    cairo_restore(cr);
+}
+
+void GTKMinesweeper::render_tile(cairo_t *cr, int tile, double size) {
+    if(tile == TILE_MINE || tile >= TILE_OPEN) {
+        // Same colours as the Windows version's revealed cells
+        cairo_set_source_rgb(cr, 0xF0 / 255.0, 0xF0 / 255.0, 0xF0 / 255.0);
+        cairo_rectangle(cr, 0, 0, size, size);
+        cairo_fill(cr);
+
+        int count = tile - TILE_OPEN;
+        if(tile == TILE_MINE) {
+            paint_pixbuf(cr, image(IMAGE_BOMB), 1, 1, size - 2);
+        } else if(count > 0) {
+            // Number colours as in the Windows version
+            static const double colors[][3] = {
+                {0.0, 0.0, 1.0},        // 1: blue
+                {0.0, 0.5, 0.0},        // 2: green
+                {1.0, 0.0, 0.0},        // 3: red
+                {0.0, 0.0, 0.545},      // 4: dark blue
+                {0.545, 0.0, 0.0},      // 5: dark red
+                {0.663, 0.663, 0.663}   // 6-8: dark gray
+            };
+            const double *color = colors[std::min(count, 6) - 1];
+            char text[2] = {static_cast<char>('0' + count), '\0'};
+            cairo_text_extents_t extents;
+            cairo_select_font_face(cr, "Sans", CAIRO_FONT_SLANT_NORMAL, CAIRO_FONT_WEIGHT_BOLD);
+            cairo_set_font_size(cr, size * 0.6);
+            cairo_text_extents(cr, text, &extents);
+            cairo_set_source_rgb(cr, color[0], color[1], color[2]);
+            cairo_move_to(cr, (size - extents.width) / 2 - extents.x_bearing,
+                          (size - extents.height) / 2 - extents.y_bearing);
+            cairo_show_text(cr, text);
         } else {
-            int count = game->countAdjacentMines(row, col);
-            if(count > 0) {
-                GtkWidget *label = gtk_label_new(std::to_string(count).c_str());
-                
-                // Create a CSS provider for the label
-                GtkCssProvider *provider = gtk_css_provider_new();
-                GtkStyleContext *context = gtk_widget_get_style_context(label);
-                
-                // Add color based on number like in Windows version
-                const char* color;
-                switch(count) {
-                    case 1: color = "blue"; break;
-                    case 2: color = "green"; break;
-                    case 3: color = "red"; break;
-                    case 4: color = "darkblue"; break;
-                    case 5: color = "darkred"; break;
-                    default: color = "darkgray"; break;
-                }
-                
-                // Create CSS string and load it
-                gchar *css = g_strdup_printf("label { color: %s; }", color);
-                gtk_css_provider_load_from_data(provider, css, -1, NULL);
-                g_free(css);
-                
-                // Apply the CSS to the label
-                gtk_style_context_add_provider(context,
-                                            GTK_STYLE_PROVIDER(provider),
-                                            GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-                g_object_unref(provider);
-                
-                gtk_widget_show(label);
-                gtk_container_add(GTK_CONTAINER(button), label);
-            } else {
-                // Show revealed background for empty cells
-                GtkWidget *image = gtk_image_new_from_pixbuf(revealed_pixbuf);
-                gtk_widget_show(image);
-                gtk_button_set_image(GTK_BUTTON(button), image);
-            }
+            paint_pixbuf(cr, image(IMAGE_REVEALED), 1, 1, size - 2);
         }
+
+        cairo_set_source_rgb(cr, 0xA0 / 255.0, 0xA0 / 255.0, 0xA0 / 255.0);
+        cairo_set_line_width(cr, 1);
+        cairo_rectangle(cr, 0.5, 0.5, size - 1, size - 1);
+        cairo_stroke(cr);
+        return;
+    }
+
+    // Cells the ghost has already cleared are tinted
+    if(tile == TILE_GHOST) {
+        cairo_set_source_rgb(cr, 0xC8 / 255.0, 0xDC / 255.0, 0xF0 / 255.0);
     } else {
-        // Unrevealed cell style with raised border effect
-        const char* unrevealed_bg_css = "button { background: #E0E0E0; border: 2px outset #D4D4D4; }";
-        gtk_css_provider_load_from_data(button_provider, unrevealed_bg_css, -1, NULL);
-        gtk_style_context_add_provider(button_context,
-                                     GTK_STYLE_PROVIDER(button_provider),
-                                     GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
-        
-        if(game->flagged[row][col]) {
-            // Show flag
-            GtkWidget *image = gtk_image_new_from_pixbuf(flag_pixbuf);
-            gtk_widget_show(image);
-            gtk_button_set_image(GTK_BUTTON(button), image);
-        }
+        cairo_set_source_rgb(cr, 0xE0 / 255.0, 0xE0 / 255.0, 0xE0 / 255.0);
+    }
+    cairo_rectangle(cr, 0, 0, size, size);
+    cairo_fill(cr);
+
+    // Raised bevel: light top and left edges, dark bottom and right
+    double bevel = std::max(1.0, std::floor(size / 12));
+    cairo_set_source_rgb(cr, 1.0, 1.0, 1.0);
+    cairo_move_to(cr, 0, size);
+    cairo_line_to(cr, 0, 0);
+    cairo_line_to(cr, size, 0);
+    cairo_line_to(cr, size - bevel, bevel);
+    cairo_line_to(cr, bevel, bevel);
+    cairo_line_to(cr, bevel, size - bevel);
+    cairo_close_path(cr);
+    cairo_fill(cr);
+    cairo_set_source_rgb(cr, 0x80 / 255.0, 0x80 / 255.0, 0x80 / 255.0);
+    cairo_move_to(cr, size, 0);
+    cairo_line_to(cr, size, size);
+    cairo_line_to(cr, 0, size);
+    cairo_line_to(cr, bevel, size - bevel);
+    cairo_line_to(cr, size - bevel, size - bevel);
+    cairo_line_to(cr, size - bevel, bevel);
+    cairo_close_path(cr);
+    cairo_fill(cr);
+
+    if(tile == TILE_FLAG) {
+        paint_pixbuf(cr, image(IMAGE_FLAG), 1, 1, size - 2);
     }
-    
-    g_object_unref(button_provider);
-    gtk_widget_show(button);
 }
 
-    GdkPixbuf* GTKMinesweeper::load_base64_image(const char* base64_data) {
-        std::vector<guchar> decoded_data;
-        gsize decoded_len;
-        guchar* raw_data = g_base64_decode(base64_data, &decoded_len);
-        
-        GInputStream* stream = g_memory_input_stream_new_from_data(raw_data, decoded_len, nullptr);
-        GError* error = nullptr;
-        GdkPixbuf* pixbuf = gdk_pixbuf_new_from_stream(stream, nullptr, &error);
-        
-        g_object_unref(stream);
-        g_free(raw_data);
-        
-        if (error) {
-            g_error_free(error);
-            return nullptr;
-        }
-        
-        return pixbuf;
+// Paints only the cells that intersect the area being redrawn, so a
+// single-cell update costs one cell however large the board is
+gboolean GTKMinesweeper::on_board_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->build_tile_atlas();
+
+    GdkRectangle clip;
+    if (!gdk_cairo_get_clip_rectangle(cr, &clip)) {
+        return FALSE;
     }
-    
-    void GTKMinesweeper::load_images() {
-        flag_pixbuf = load_base64_image(FLAG_BASE64);
-        bomb_pixbuf = load_base64_image(BOMB_BASE64);
-        revealed_pixbuf = load_base64_image(REVEALED_BASE64);
-        app_icon = load_base64_image(ICON_BASE64);
-        
-        if (app_icon) {
-            gtk_window_set_icon(GTK_WINDOW(window), app_icon);
+    int size = minesweeper->cell_size;
+    int first_col = std::max(0, (clip.x - minesweeper->board_x) / size);
+    int first_row = std::max(0, (clip.y - minesweeper->board_y) / size);
+    int last_col = std::min(minesweeper->game->width - 1,
+                            (clip.x + clip.width - 1 - minesweeper->board_x) / size);
+    int last_row = std::min(minesweeper->game->height - 1,
+                            (clip.y + clip.height - 1 - minesweeper->board_y) / size);
+
+    for (int row = first_row; row <= last_row; row++) {
+        int y = minesweeper->board_y + row * size;
+        for (int col = first_col; col <= last_col; col++) {
+            int x = minesweeper->board_x + col * size;
+            int tile = minesweeper->tile_for(row, col);
+            cairo_set_source_surface(cr, minesweeper->tile_atlas, x - tile * size, y);
+            cairo_rectangle(cr, x, y, size, size);
+            cairo_fill(cr);
         }
     }
-    
-    void GTKMinesweeper::cleanup_images() {
-        if (flag_pixbuf) g_object_unref(flag_pixbuf);
-        if (bomb_pixbuf) g_object_unref(bomb_pixbuf);
-        if (revealed_pixbuf) g_object_unref(revealed_pixbuf);
-        if (app_icon) g_object_unref(app_icon);
+    return FALSE;
+}
+
+// The images are compiled into the binary by glib-compile-resources (see
+// minesweeper.gresource.xml), so nothing is decoded at startup. Each is
+// decoded on first use and then shared by every window for the life of
+// the process.
+GdkPixbuf* GTKMinesweeper::image(Image which) {
+    static const char* const paths[IMAGE_COUNT] = {
+        "/org/gtk/minesweeper/images/flag.png",
+        "/org/gtk/minesweeper/images/bomb.png",
+        "/org/gtk/minesweeper/images/revealed.png",
+        "/org/gtk/minesweeper/images/icon.ico"
+    };
+    static GdkPixbuf* loaded[IMAGE_COUNT];
+    if (!loaded[which]) {
+        loaded[which] = gdk_pixbuf_new_from_resource(paths[which], nullptr);
     }
+    return loaded[which];
+}
+
+// The window manager does not need the icon for the first frame, so its
+// decoder runs once the window is up
+gboolean GTKMinesweeper::set_window_icon(gpointer user_data) {
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    GdkPixbuf *icon = image(IMAGE_ICON);
+    if (icon) {
+        gtk_window_set_icon(GTK_WINDOW(minesweeper->window), icon);
+    }
+    return G_SOURCE_REMOVE;
+}
 
 GTKMinesweeper::GTKMinesweeper() 
     : game(std::make_unique<Minesweeper>())
     , window(nullptr)
-    , grid(nullptr)
+    , board_area(nullptr)
+    , hscrollbar(nullptr)
+    , vscrollbar(nullptr)
+    , hadjustment(nullptr)
+    , vadjustment(nullptr)
+    , zoom_gesture(nullptr)
+    , minimap_area(nullptr)
     , timer_label(nullptr)
     , mines_label(nullptr)
+    , ghost_label(nullptr)
     , menubar(nullptr)
     , timer_id(0)
-    , flag_pixbuf(nullptr)
-    , bomb_pixbuf(nullptr)
-    , revealed_pixbuf(nullptr)
-    , app_icon(nullptr) {
+    , shown_seconds(-1)
+    , ghost_tick_id(0)
+    , cell_size(1)
+    , board_x(0)
+    , board_y(0)
+    , fit_to_view(true)
+    , pinch_start_size(1)
+    , minimap_surface(nullptr)
+    , minimap_level(0)
+    , minimap_zoom(1)
+    , tile_atlas(nullptr)
+    , atlas_cell_size(0)
+    , atlas_scale(0) {
     
     game->setDifficulty(Difficulty::EASY);
-    load_images();
 }
 
 GTKMinesweeper::~GTKMinesweeper() {
@@ -438,7 +490,13 @@ GTKMinesweeper::~GTKMinesweeper() {
         g_source_remove(timer_id);
         timer_id = 0;
     }
-    cleanup_images();
+    if (zoom_gesture) {
+        g_object_unref(zoom_gesture);
+    }
+    if (minimap_surface) {
+        cairo_surface_destroy(minimap_surface);
+    }
+    clear_tile_atlas();
 }
 
 void GTKMinesweeper::create_window(GtkApplication *app) {
@@ -483,18 +541,73 @@ void GTKMinesweeper::create_window(GtkApplication *app) {
     mines_label = gtk_label_new("Mines: 10");
     gtk_box_pack_start(GTK_BOX(info_box), timer_label, TRUE, TRUE, 5);
     gtk_box_pack_start(GTK_BOX(info_box), mines_label, TRUE, TRUE, 5);
+
+    // Ghost race status, only shown while racing a replay
+    ghost_label = gtk_label_new("");
+    gtk_widget_set_no_show_all(ghost_label, TRUE);
+    gtk_box_pack_start(GTK_BOX(info_box), ghost_label, TRUE, TRUE, 5);
     
-    // Game grid
-    grid = gtk_grid_new();
-    gtk_grid_set_row_spacing(GTK_GRID(grid), 1);
-    gtk_grid_set_column_spacing(GTK_GRID(grid), 1);
-    gtk_box_pack_start(GTK_BOX(content_box), grid, TRUE, TRUE, 5);
+    // Game board: one drawing area, painted with Cairo and hit-tested by
+    // position, however many cells the board has. It never grows past the
+    // window; the scrollbars move the board underneath it instead.
+    hadjustment = gtk_adjustment_new(0, 0, 1, 1, 1, 1);
+    vadjustment = gtk_adjustment_new(0, 0, 1, 1, 1, 1);
+    g_signal_connect(G_OBJECT(hadjustment), "value-changed", G_CALLBACK(on_view_scrolled), this);
+    g_signal_connect(G_OBJECT(vadjustment), "value-changed", G_CALLBACK(on_view_scrolled), this);
+
+    board_area = gtk_drawing_area_new();
+    gtk_widget_set_vexpand(board_area, TRUE);
+    gtk_widget_set_hexpand(board_area, TRUE);
+    gtk_widget_add_events(board_area, GDK_BUTTON_PRESS_MASK | GDK_SCROLL_MASK |
+                                      GDK_SMOOTH_SCROLL_MASK | GDK_TOUCH_MASK |
+                                      GDK_TOUCHPAD_GESTURE_MASK);
+    g_signal_connect(G_OBJECT(board_area), "draw", G_CALLBACK(on_board_draw), this);
+    g_signal_connect(G_OBJECT(board_area), "button-press-event", G_CALLBACK(on_board_press), this);
+    g_signal_connect(G_OBJECT(board_area), "scroll-event", G_CALLBACK(on_board_scroll), this);
+    g_signal_connect(G_OBJECT(board_area), "size-allocate", G_CALLBACK(on_board_allocate), this);
+
+    zoom_gesture = gtk_gesture_zoom_new(board_area);
+    g_signal_connect(G_OBJECT(zoom_gesture), "begin", G_CALLBACK(on_pinch_begin), this);
+    g_signal_connect(G_OBJECT(zoom_gesture), "scale-changed", G_CALLBACK(on_pinch_scale), this);
+
+    hscrollbar = gtk_scrollbar_new(GTK_ORIENTATION_HORIZONTAL, hadjustment);
+    vscrollbar = gtk_scrollbar_new(GTK_ORIENTATION_VERTICAL, vadjustment);
+    gtk_widget_set_no_show_all(hscrollbar, TRUE);
+    gtk_widget_set_no_show_all(vscrollbar, TRUE);
+
+    // Minimap floats over the top right corner of the board
+    minimap_area = gtk_drawing_area_new();
+    gtk_widget_set_halign(minimap_area, GTK_ALIGN_END);
+    gtk_widget_set_valign(minimap_area, GTK_ALIGN_START);
+    gtk_widget_set_margin_end(minimap_area, 8);
+    gtk_widget_set_margin_top(minimap_area, 8);
+    gtk_widget_set_no_show_all(minimap_area, TRUE);
+    gtk_widget_add_events(minimap_area, GDK_BUTTON_PRESS_MASK | GDK_BUTTON_MOTION_MASK);
+    g_signal_connect(G_OBJECT(minimap_area), "draw", G_CALLBACK(on_minimap_draw), this);
+    g_signal_connect(G_OBJECT(minimap_area), "button-press-event", G_CALLBACK(on_minimap_press), this);
+    g_signal_connect(G_OBJECT(minimap_area), "motion-notify-event", G_CALLBACK(on_minimap_motion), this);
+
+    GtkWidget *board_overlay = gtk_overlay_new();
+    gtk_container_add(GTK_CONTAINER(board_overlay), board_area);
+    gtk_overlay_add_overlay(GTK_OVERLAY(board_overlay), minimap_area);
+
+    GtkWidget *board_grid = gtk_grid_new();
+    gtk_grid_attach(GTK_GRID(board_grid), board_overlay, 0, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(board_grid), vscrollbar, 1, 0, 1, 1);
+    gtk_grid_attach(GTK_GRID(board_grid), hscrollbar, 0, 1, 1, 1);
+    gtk_box_pack_start(GTK_BOX(content_box), board_grid, TRUE, TRUE, 5);
     
     initialize_grid();
     
     gtk_widget_show_all(window);
-    
-    timer_id = g_timeout_add(100, G_SOURCE_FUNC(update_timer), this);
+    g_idle_add_full(G_PRIORITY_LOW, set_window_icon, this, NULL);
+
+    // Scores and the game history are read and written in the background;
+    // the window never waits on the disk
+    game->highscores.preload();
+    game->history.preload();
+    game->highscores.startBackgroundWriter();
+    game->history.writeInBackground(game->highscores);
 }
 
 void GTKMinesweeper::create_menu() {
@@ -527,6 +640,11 @@ void GTKMinesweeper::create_menu() {
     gtk_menu_shell_append(GTK_MENU_SHELL(game_menu), set_seed);
     gtk_widget_add_accelerator(set_seed, "activate", accel_group, GDK_KEY_s, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
 
+    GtkWidget *ghost_race = gtk_menu_item_new_with_label("Race Ghost...");
+    g_signal_connect(G_OBJECT(ghost_race), "activate", G_CALLBACK(on_ghost_race), this);
+    gtk_menu_shell_append(GTK_MENU_SHELL(game_menu), ghost_race);
+    gtk_widget_add_accelerator(ghost_race, "activate", accel_group, GDK_KEY_g, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+
     GtkWidget *quit = gtk_menu_item_new_with_label("Quit");
     g_signal_connect(G_OBJECT(quit), "activate", G_CALLBACK(on_quit), this);
     gtk_menu_shell_append(GTK_MENU_SHELL(game_menu), quit);
@@ -568,6 +686,27 @@ void GTKMinesweeper::create_menu() {
     gtk_widget_add_accelerator(custom, "activate", accel_group, GDK_KEY_4, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
 
 
+    // View menu
+    GtkWidget *view_menu = gtk_menu_new();
+    GtkWidget *view_item = gtk_menu_item_new_with_label("View");
+    gtk_menu_item_set_submenu(GTK_MENU_ITEM(view_item), view_menu);
+
+    GtkWidget *zoom_in = gtk_menu_item_new_with_label("Zoom In");
+    g_signal_connect(G_OBJECT(zoom_in), "activate", G_CALLBACK(on_zoom_in), this);
+    gtk_menu_shell_append(GTK_MENU_SHELL(view_menu), zoom_in);
+    gtk_widget_add_accelerator(zoom_in, "activate", accel_group, GDK_KEY_plus, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+    gtk_widget_add_accelerator(zoom_in, "activate", accel_group, GDK_KEY_equal, GDK_CONTROL_MASK, (GtkAccelFlags)0);
+
+    GtkWidget *zoom_out = gtk_menu_item_new_with_label("Zoom Out");
+    g_signal_connect(G_OBJECT(zoom_out), "activate", G_CALLBACK(on_zoom_out), this);
+    gtk_menu_shell_append(GTK_MENU_SHELL(view_menu), zoom_out);
+    gtk_widget_add_accelerator(zoom_out, "activate", accel_group, GDK_KEY_minus, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+
+    GtkWidget *zoom_fit = gtk_menu_item_new_with_label("Fit Board");
+    g_signal_connect(G_OBJECT(zoom_fit), "activate", G_CALLBACK(on_zoom_fit), this);
+    gtk_menu_shell_append(GTK_MENU_SHELL(view_menu), zoom_fit);
+    gtk_widget_add_accelerator(zoom_fit, "activate", accel_group, GDK_KEY_0, GDK_CONTROL_MASK, GTK_ACCEL_VISIBLE);
+
     // Help menu
     GtkWidget *help_menu = gtk_menu_new();
     GtkWidget *help_item = gtk_menu_item_new_with_label("Help");
@@ -584,6 +723,7 @@ void GTKMinesweeper::create_menu() {
 
     gtk_menu_shell_append(GTK_MENU_SHELL(menubar), game_item);
     gtk_menu_shell_append(GTK_MENU_SHELL(menubar), diff_item);
+    gtk_menu_shell_append(GTK_MENU_SHELL(menubar), view_item);
     gtk_menu_shell_append(GTK_MENU_SHELL(menubar), help_item);
 
     gtk_window_add_accel_group(GTK_WINDOW(window), accel_group);
@@ -591,54 +731,20 @@ void GTKMinesweeper::create_menu() {
 
 
 void GTKMinesweeper::initialize_grid() {
-    GList *children = gtk_container_get_children(GTK_CONTAINER(grid));
-    for(GList *iter = children; iter != NULL; iter = g_list_next(iter)) {
-        gtk_widget_destroy(GTK_WIDGET(iter->data));
-    }
-    g_list_free(children);
-    
-    // Set grid to expand
-    gtk_widget_set_vexpand(grid, TRUE);
-    gtk_widget_set_hexpand(grid, TRUE);
-    gtk_grid_set_row_homogeneous(GTK_GRID(grid), TRUE);
-    gtk_grid_set_column_homogeneous(GTK_GRID(grid), TRUE);
-    
-    buttons.resize(game->height);
-    for(int i = 0; i < game->height; i++) {
-        buttons[i].resize(game->width);
-        for(int j = 0; j < game->width; j++) {
-            GtkWidget *button = gtk_button_new();
-            
-            // Make buttons expand
-            gtk_widget_set_vexpand(button, TRUE);
-            gtk_widget_set_hexpand(button, TRUE);
-            
-            // Set minimum size to prevent buttons from becoming too small
-            gtk_widget_set_size_request(button, 25, 25);
-            
-            g_object_set_data(G_OBJECT(button), "row", GINT_TO_POINTER(i));
-            g_object_set_data(G_OBJECT(button), "col", GINT_TO_POINTER(j));
-            
-            g_signal_connect(G_OBJECT(button), "button-press-event",
-                           G_CALLBACK(on_button_click), this);
-            
-            gtk_grid_attach(GTK_GRID(grid), button, j, i, 1, 1);
-            buttons[i][j] = button;
-        }
-    }
-    
-    gtk_widget_show_all(grid);
+    // Cells start at 25 pixels like the old buttons. Boards that would not
+    // fit on screen at that size open at a window-sized view and scroll.
+    gtk_widget_set_size_request(board_area, std::min(25 * game->width, 800),
+                                std::min(25 * game->height, 600));
+    gtk_adjustment_set_value(hadjustment, 0);
+    gtk_adjustment_set_value(vadjustment, 0);
+    reset_minimap();
+    zoom_to_fit();
+    sync_timer();
 }
 
 void GTKMinesweeper::update_mine_counter() {
-    int flagged_count = 0;
-    for(int i = 0; i < game->height; i++) {
-        for(int j = 0; j < game->width; j++) {
-            if(game->flagged[i][j]) flagged_count++;
-        }
-    }
     gtk_label_set_text(GTK_LABEL(mines_label), 
-                      ("Mines: " + std::to_string(game->mines - flagged_count)).c_str());
+                      ("Mines: " + std::to_string(game->mines - game->flagCount)).c_str());
 }
 
 void GTKMinesweeper::show_high_scores() {
@@ -696,7 +802,7 @@ void GTKMinesweeper::show_high_scores() {
     for (const auto& score : scores) {
         // Create labels for each column
         GtkWidget *name_label = gtk_label_new(score.name.c_str());
-        GtkWidget *time_label = gtk_label_new((std::to_string(score.time) + "s").c_str());
+        GtkWidget *time_label = gtk_label_new(formatScoreTime(score.timeMs).c_str());
         GtkWidget *diff_label = gtk_label_new(score.difficulty.c_str());
 
         // Align labels to the left
@@ -719,108 +825,231 @@ void GTKMinesweeper::show_high_scores() {
     gtk_widget_destroy(dialog);
 }
 
-// Add these helper methods to the Minesweeper class:
-int Minesweeper::countAdjacentFlags(int y, int x) {
-    int count = 0;
-    for (int dy = -1; dy <= 1; dy++) {
-        for (int dx = -1; dx <= 1; dx++) {
-            int newY = y + dy;
-            int newX = x + dx;
-            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-                if (flagged[newY][newX]) count++;
-            }
-        }
+gboolean GTKMinesweeper::on_board_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    // A double click also sends GDK_2BUTTON_PRESS; only single presses count
+    if (event->type != GDK_BUTTON_PRESS) {
+        return FALSE;
     }
-    return count;
-}
-
-void Minesweeper::revealAdjacent(int y, int x) {
-    if (!revealed[y][x]) return;
-
-    int mineCount = countAdjacentMines(y, x);
-    int flagCount = countAdjacentFlags(y, x);
-
-    if (mineCount == flagCount) {
-        for (int dy = -1; dy <= 1; dy++) {
-            for (int dx = -1; dx <= 1; dx++) {
-                int newY = y + dy;
-                int newX = x + dx;
-                if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
-                    if (!flagged[newY][newX] && !revealed[newY][newX]) {
-                        if (minefield[newY][newX]) {
-                            gameOver = true;
-                            revealAllMines();
-                            timer.stop();
-                            return;
-                        }
-                        revealCell(newY, newX);
-                    }
-                }
-            }
+    int row, col;
+    if (!minesweeper->cell_at(event->x, event->y, row, col)) {
+        return FALSE;
+    }
+    minesweeper->handle_click(row, col, event->button);
+    return TRUE;
+}
+
+// The wheel pans the board, and zooms around the pointer with Ctrl held.
+// Touchpads send smooth deltas, scaled like GtkScrolledWindow does.
+gboolean GTKMinesweeper::on_board_scroll(GtkWidget *widget, GdkEventScroll *event, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    double dx = 0, dy = 0;
+    switch (event->direction) {
+        case GDK_SCROLL_UP: dy = -1; break;
+        case GDK_SCROLL_DOWN: dy = 1; break;
+        case GDK_SCROLL_LEFT: dx = -1; break;
+        case GDK_SCROLL_RIGHT: dx = 1; break;
+        case GDK_SCROLL_SMOOTH: gdk_event_get_scroll_deltas((GdkEvent*)event, &dx, &dy); break;
+    }
+
+    if (event->state & GDK_CONTROL_MASK) {
+        if (dy != 0) {
+            minesweeper->zoom_at(std::pow(1.25, -dy), event->x, event->y);
         }
-        if (checkWin()) {
-            won = true;
-            timer.stop();
+        return TRUE;
+    }
+
+    // Shift turns a vertical wheel into horizontal panning
+    if ((event->state & GDK_SHIFT_MASK) && dx == 0) {
+        std::swap(dx, dy);
+    }
+    GtkAdjustment *adjustments[] = {minesweeper->hadjustment, minesweeper->vadjustment};
+    double deltas[] = {dx, dy};
+    for (int i = 0; i < 2; i++) {
+        if (deltas[i] == 0) {
+            continue;
         }
+        double page = gtk_adjustment_get_page_size(adjustments[i]);
+        double step = std::pow(page, 2.0 / 3.0);
+        gtk_adjustment_set_value(adjustments[i], gtk_adjustment_get_value(adjustments[i]) + deltas[i] * step);
+    }
+    return TRUE;
+}
+
+void GTKMinesweeper::on_board_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data) {
+    (void)widget;      // Unused parameter
+    (void)allocation;  // Unused parameter
+    static_cast<GTKMinesweeper*>(user_data)->update_layout();
+}
+
+void GTKMinesweeper::on_view_scrolled(GtkAdjustment *adjustment, gpointer user_data) {
+    (void)adjustment;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->update_origin();
+    minesweeper->update_all_cells();
+    gtk_widget_queue_draw(minesweeper->minimap_area);
+}
+
+void GTKMinesweeper::on_pinch_begin(GtkGesture *gesture, GdkEventSequence *sequence, gpointer user_data) {
+    (void)gesture;   // Unused parameter
+    (void)sequence;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->pinch_start_size = minesweeper->cell_size;
+}
+
+// scale is relative to the start of the pinch, so the zoom follows the
+// fingers rather than compounding every event
+void GTKMinesweeper::on_pinch_scale(GtkGestureZoom *gesture, gdouble scale, gpointer user_data) {
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    double target = minesweeper->pinch_start_size * scale;
+    if (std::lround(target) == minesweeper->cell_size) {
+        return;
+    }
+    double x, y;
+    if (!gtk_gesture_get_bounding_box_center(GTK_GESTURE(gesture), &x, &y)) {
+        x = gtk_widget_get_allocated_width(minesweeper->board_area) / 2.0;
+        y = gtk_widget_get_allocated_height(minesweeper->board_area) / 2.0;
     }
+    minesweeper->zoom_at(target / minesweeper->cell_size, x, y);
+}
+
+void GTKMinesweeper::on_zoom_in(GtkWidget *widget, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->zoom_at(1.25, gtk_widget_get_allocated_width(minesweeper->board_area) / 2.0,
+                         gtk_widget_get_allocated_height(minesweeper->board_area) / 2.0);
+}
+
+void GTKMinesweeper::on_zoom_out(GtkWidget *widget, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->zoom_at(0.8, gtk_widget_get_allocated_width(minesweeper->board_area) / 2.0,
+                         gtk_widget_get_allocated_height(minesweeper->board_area) / 2.0);
+}
+
+void GTKMinesweeper::on_zoom_fit(GtkWidget *widget, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    static_cast<GTKMinesweeper*>(user_data)->zoom_to_fit();
 }
 
-// Modify the on_button_click handler:
-void GTKMinesweeper::on_button_click(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+gboolean GTKMinesweeper::on_minimap_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data) {
+    (void)widget;  // Unused parameter
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
-    int row = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(widget), "row"));
-    int col = GPOINTER_TO_INT(g_object_get_data(G_OBJECT(widget), "col"));
+    int level = minesweeper->minimap_level;
+    int zoom = minesweeper->minimap_zoom;
+    int width = minesweeper->minimap.width(level) * zoom;
+    int height = minesweeper->minimap.height(level) * zoom;
+
+    cairo_set_source_rgb(cr, 0x40 / 255.0, 0x40 / 255.0, 0x40 / 255.0);
+    cairo_paint(cr);
+    cairo_save(cr);
+    cairo_translate(cr, 1, 1);
+    cairo_scale(cr, zoom, zoom);
+    cairo_set_source_surface(cr, minesweeper->minimap_surface, 0, 0);
+    cairo_pattern_set_filter(cairo_get_source(cr), CAIRO_FILTER_NEAREST);
+    cairo_paint(cr);
+    cairo_restore(cr);
+
+    // The part of the board in view
+    int board_width = minesweeper->game->width * minesweeper->cell_size;
+    int board_height = minesweeper->game->height * minesweeper->cell_size;
+    double scale_x = static_cast<double>(width) / board_width;
+    double scale_y = static_cast<double>(height) / board_height;
+    double view_x = std::max(0, -minesweeper->board_x);
+    double view_y = std::max(0, -minesweeper->board_y);
+    double view_width = std::min<double>(gtk_widget_get_allocated_width(minesweeper->board_area), board_width);
+    double view_height = std::min<double>(gtk_widget_get_allocated_height(minesweeper->board_area), board_height);
+    cairo_set_source_rgb(cr, 0.0, 0.4, 1.0);
+    cairo_set_line_width(cr, 2);
+    cairo_rectangle(cr, 1 + view_x * scale_x, 1 + view_y * scale_y,
+                    view_width * scale_x, view_height * scale_y);
+    cairo_stroke(cr);
+    return FALSE;
+}
+
+gboolean GTKMinesweeper::on_minimap_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    if (event->button != 1) {
+        return FALSE;
+    }
+    static_cast<GTKMinesweeper*>(user_data)->jump_to_minimap(event->x, event->y);
+    return TRUE;
+}
+
+// Dragging across the minimap keeps the view under the pointer
+gboolean GTKMinesweeper::on_minimap_motion(GtkWidget *widget, GdkEventMotion *event, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    if (!(event->state & GDK_BUTTON1_MASK)) {
+        return FALSE;
+    }
+    static_cast<GTKMinesweeper*>(user_data)->jump_to_minimap(event->x, event->y);
+    return TRUE;
+}
 
-    if (minesweeper->game->won || minesweeper->game->gameOver) {
+void GTKMinesweeper::handle_click(int row, int col, guint button) {
+    if (game->won || game->gameOver) {
          return;
     }
-    
-    if(event->button == 1) { // Left click
-        if(minesweeper->game->firstMove) {
-            minesweeper->game->initializeMinefield(row, col, -1);
-            minesweeper->game->firstMove = false;
-            minesweeper->game->timer.start();
+
+    // Left or middle click on a revealed number chords its neighbours
+    if((button == 1 || button == 2) && game->revealed[row][col]) {
+        // Only a chord that opened something is a move
+        size_t changedBefore = game->changedCells.size();
+        game->revealAdjacent(row, col);
+        if (game->changedCells.size() != changedBefore) {
+            game->recordMove(MoveType::CHORD, row, col);
         }
-        
-        if(minesweeper->game->revealed[row][col]) {
-            // If clicking on a revealed number, try to reveal adjacent
-            minesweeper->game->revealAdjacent(row, col);
-            minesweeper->update_all_cells();
-            if(minesweeper->game->gameOver) {
-                minesweeper->show_game_over_dialog();
-            } else if(minesweeper->game->won) {
-                minesweeper->show_win_dialog();
-            }
-        } else if(!minesweeper->game->flagged[row][col]) {
-            if(minesweeper->game->minefield[row][col]) {
-                minesweeper->game->gameOver = true;
-                minesweeper->game->revealAllMines();
-                minesweeper->game->timer.stop();
-                minesweeper->update_all_cells();
+        update_changed_cells();
+        sync_timer();
+        if(game->gameOver) {
+            show_game_over_dialog();
+        } else if(game->won) {
+            show_win_dialog();
+        }
+    } else if(button == 1) { // Left click
+        if(game->firstMove) {
+            game->initializeMinefield(row, col);
+            game->firstMove = false;
+            game->timer.start();
+            sync_timer();
+        }
+
+        if(!game->flagged[row][col]) {
+            game->recordMove(MoveType::REVEAL, row, col);
+            if(game->minefield[row][col]) {
+                game->gameOver = true;
+                game->revealAllMines();
+                game->timer.stop();
+                sync_timer();
+                update_changed_cells();
                 while (gtk_events_pending()) {
                     gtk_main_iteration();
                 }
-                minesweeper->show_game_over_dialog();
+                show_game_over_dialog();
             } else {
-                minesweeper->game->revealCell(row, col);
-                if(minesweeper->game->checkWin()) {
-                    minesweeper->game->won = true;
-                    minesweeper->game->timer.stop();
-                    minesweeper->update_all_cells();
+                game->revealCell(row, col);
+                if(game->checkWin()) {
+                    game->won = true;
+                    game->timer.stop();
+                    sync_timer();
+                    update_changed_cells();
                     while (gtk_events_pending()) {
                         gtk_main_iteration();
                     }
-                    minesweeper->show_win_dialog();
+                    show_win_dialog();
                 } else {
-                    minesweeper->update_all_cells();
+                    update_changed_cells();
                 }
             }
         }
-    } else if(event->button == 3) { // Right click
-        if(!minesweeper->game->revealed[row][col]) {
-            minesweeper->game->flagged[row][col] = !minesweeper->game->flagged[row][col];
-            minesweeper->update_cell(row, col);
-            minesweeper->update_mine_counter();
+    } else if(button == 3) { // Right click
+        if(!game->revealed[row][col]) {
+            game->recordMove(MoveType::FLAG, row, col);
+            game->toggleFlag(row, col);
+            update_changed_cells();
+            update_mine_counter();
         }
     }
 }
@@ -828,24 +1057,12 @@ void GTKMinesweeper::on_button_click(GtkWidget *widget, GdkEventButton *event, g
 void GTKMinesweeper::on_new_game(GtkWidget *widget, gpointer user_data) {
     (void)widget;  // Unused parameter
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->stop_ghost_race();
     minesweeper->game->reset();
     minesweeper->initialize_grid();
     minesweeper->update_mine_counter();
 }
 
-void Minesweeper::resetWithSeed() {
-    reset();  // Do regular reset first
-    
-    // If we have a valid seed from a previous game
-    if (currentSeed != 0) {
-        // Reinitialize the minefield with the same seed
-        initializeMinefield(0, 0, currentSeed);
-        // We don't want the first move protection since we're recreating a specific board
-        firstMove = false;
-        timer.start();
-    }
-}
-
 void GTKMinesweeper::show_seed_dialog() {
     GtkWidget *dialog = gtk_dialog_new_with_buttons(
         "Set Custom Seed",
@@ -882,7 +1099,13 @@ void GTKMinesweeper::show_seed_dialog() {
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
         const gchar *text = gtk_entry_get_text(GTK_ENTRY(entry));
         try {
-            int seed = std::stoi(text);
+            // The full unsigned range, as replays record it
+            unsigned long value = std::stoul(text);
+            if (std::strchr(text, '-') || value > 0xFFFFFFFFUL) {
+                throw std::out_of_range("seed");
+            }
+            unsigned int seed = static_cast<unsigned int>(value);
+            stop_ghost_race();
             game->reset();
             game->initializeMinefield(0, 0, seed);
             game->firstMove = false;  // Skip first move protection for custom seeds
@@ -915,6 +1138,7 @@ void GTKMinesweeper::on_reset_game(GtkWidget *widget, gpointer user_data) {
     (void)widget;  // Unused parameter
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
     
+    minesweeper->stop_ghost_race();
     minesweeper->game->resetWithSeed();
     minesweeper->initialize_grid();
     minesweeper->update_mine_counter();
@@ -937,6 +1161,7 @@ void GTKMinesweeper::on_difficulty(GtkWidget *widget, gpointer difficulty) {
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(
         g_object_get_data(G_OBJECT(widget), "minesweeper"));
     int diff = GPOINTER_TO_INT(difficulty);
+    minesweeper->stop_ghost_race();
     minesweeper->game->setDifficulty(static_cast<Difficulty>(diff));
     minesweeper->initialize_grid();
     minesweeper->update_mine_counter();
@@ -983,14 +1208,14 @@ void GTKMinesweeper::show_custom_board_dialog() {
     gtk_container_add(GTK_CONTAINER(content_area), grid);
 
     // Width input
-    GtkWidget *width_label = gtk_label_new("Width (8-50):");
+    GtkWidget *width_label = gtk_label_new("Width (8-2000):");
     GtkWidget *width_entry = gtk_entry_new();
     gtk_entry_set_text(GTK_ENTRY(width_entry), std::to_string(game->width).c_str());
     gtk_grid_attach(GTK_GRID(grid), width_label, 0, 0, 1, 1);
     gtk_grid_attach(GTK_GRID(grid), width_entry, 1, 0, 1, 1);
 
     // Height input
-    GtkWidget *height_label = gtk_label_new("Height (8-50):");
+    GtkWidget *height_label = gtk_label_new("Height (8-2000):");
     GtkWidget *height_entry = gtk_entry_new();
     gtk_entry_set_text(GTK_ENTRY(height_entry), std::to_string(game->height).c_str());
     gtk_grid_attach(GTK_GRID(grid), height_label, 0, 1, 1, 1);
@@ -1012,8 +1237,8 @@ void GTKMinesweeper::show_custom_board_dialog() {
             int mines = std::stoi(gtk_entry_get_text(GTK_ENTRY(mines_entry)));
 
             // Validate input
-            if (width < 8 || width > 50 || height < 8 || height > 50) {
-                throw std::invalid_argument("Board dimensions must be between 8 and 50");
+            if (width < 8 || width > 2000 || height < 8 || height > 2000) {
+                throw std::invalid_argument("Board dimensions must be between 8 and 2000");
             }
 
             int maxMines = (width * height) - 9; // Leave room for first click
@@ -1022,6 +1247,7 @@ void GTKMinesweeper::show_custom_board_dialog() {
             }
 
             // Set custom board size
+            stop_ghost_race();
             game->width = width;
             game->height = height;
             game->mines = mines;
@@ -1051,6 +1277,151 @@ void GTKMinesweeper::on_custom_board(GtkWidget *widget, gpointer user_data) {
 }
 
 
+// Replays are kept next to the high score file
+static std::string replay_directory() {
+#ifdef _WIN32
+    const char *home = g_getenv("APPDATA");
+#else
+    const char *home = g_get_home_dir();
+#endif
+    if (!home) {
+        home = ".";
+    }
+    gchar *path = g_build_filename(home, ".minesweeper", "replays", NULL);
+    g_mkdir_with_parents(path, 0700);
+    std::string result(path);
+    g_free(path);
+    return result;
+}
+
+void GTKMinesweeper::save_replay() {
+    if (game->replay.empty()) {
+        return;
+    }
+    std::string name = std::to_string(game->currentSeed) + "_" +
+                       std::to_string(game->timer.getElapsedMillis()) + ".replay";
+    gchar *path = g_build_filename(replay_directory().c_str(), name.c_str(), NULL);
+    game->replay.save(path);
+    g_free(path);
+}
+
+void GTKMinesweeper::show_ghost_race_dialog() {
+    GtkWidget *dialog = gtk_file_chooser_dialog_new(
+        "Race Ghost",
+        GTK_WINDOW(window),
+        GTK_FILE_CHOOSER_ACTION_OPEN,
+        "_Cancel",
+        GTK_RESPONSE_CANCEL,
+        "_Open",
+        GTK_RESPONSE_ACCEPT,
+        NULL);
+
+    gtk_file_chooser_set_current_folder(GTK_FILE_CHOOSER(dialog), replay_directory().c_str());
+
+    GtkFileFilter *filter = gtk_file_filter_new();
+    gtk_file_filter_set_name(filter, "Minesweeper replays");
+    gtk_file_filter_add_pattern(filter, "*.replay");
+    gtk_file_chooser_add_filter(GTK_FILE_CHOOSER(dialog), filter);
+
+    std::string path;
+    if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
+        gchar *filename = gtk_file_chooser_get_filename(GTK_FILE_CHOOSER(dialog));
+        if (filename) {
+            path = filename;
+            g_free(filename);
+        }
+    }
+    gtk_widget_destroy(dialog);
+
+    if (!path.empty()) {
+        start_ghost_race(path);
+    }
+}
+
+void GTKMinesweeper::start_ghost_race(const std::string& path) {
+    stop_ghost_race();
+
+    if (!ghost.start(path)) {
+        GtkWidget *error_dialog = gtk_message_dialog_new(
+            GTK_WINDOW(window),
+            GTK_DIALOG_MODAL,
+            GTK_MESSAGE_ERROR,
+            GTK_BUTTONS_OK,
+            "Could not read replay file.");
+        gtk_dialog_run(GTK_DIALOG(error_dialog));
+        gtk_widget_destroy(error_dialog);
+        return;
+    }
+
+    // Recreate the ghost's board: same size, seed and first click
+    const ReplayHeader& header = ghost.getHeader();
+    game->height = header.height;
+    game->width = header.width;
+    game->mines = header.mines;
+    game->reset();
+    game->initializeMinefield(header.firstRow, header.firstCol, header.seed);
+    game->firstMove = false;
+    game->timer.start();
+    ghost.attach(&game->minefield);
+
+    initialize_grid();
+    update_all_cells();
+    update_mine_counter();
+
+    gtk_label_set_text(GTK_LABEL(ghost_label), "Ghost: racing");
+    gtk_widget_show(ghost_label);
+    ghost_tick_id = gtk_widget_add_tick_callback(window, ghost_tick, this, NULL);
+}
+
+void GTKMinesweeper::stop_ghost_race() {
+    if (ghost_tick_id > 0) {
+        gtk_widget_remove_tick_callback(window, ghost_tick_id);
+        ghost_tick_id = 0;
+    }
+    ghost.stop();
+    if (ghost_label) {
+        gtk_widget_hide(ghost_label);
+    }
+}
+
+void GTKMinesweeper::on_ghost_race(GtkWidget *widget, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+    minesweeper->show_ghost_race_dialog();
+}
+
+// Runs once per frame while racing. Decoding is incremental and only cells
+// the ghost changed this frame are repainted, so the cost per frame is tied
+// to the ghost's progress rather than the board size.
+gboolean GTKMinesweeper::ghost_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer user_data) {
+    (void)widget;  // Unused parameter
+    (void)clock;   // Unused parameter
+    GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
+
+    minesweeper->ghost_changed.clear();
+    minesweeper->ghost.advance(minesweeper->game->timer.getElapsedMillis(),
+                               minesweeper->ghost_changed);
+    for (const auto& cell : minesweeper->ghost_changed) {
+        minesweeper->update_cell(cell.first, cell.second);
+    }
+
+    bool player_done = minesweeper->game->gameOver || minesweeper->game->won;
+    if (minesweeper->ghost.isFinished() || player_done) {
+        if (minesweeper->ghost.isFinished() && !minesweeper->ghost.hasCleared()) {
+            gtk_label_set_text(GTK_LABEL(minesweeper->ghost_label), "Ghost: hit a mine");
+        } else if (minesweeper->ghost.isFinished()) {
+            uint32_t ms = minesweeper->ghost.getFinishMs();
+            gchar *text = g_strdup_printf("Ghost: %02u:%02u.%03u",
+                                          ms / 60000, (ms / 1000) % 60, ms % 1000);
+            gtk_label_set_text(GTK_LABEL(minesweeper->ghost_label), text);
+            g_free(text);
+        }
+        minesweeper->ghost_tick_id = 0;
+        return G_SOURCE_REMOVE;
+    }
+    return G_SOURCE_CONTINUE;
+}
+
 void GTKMinesweeper::on_about(GtkWidget *widget, gpointer user_data) {
     (void)widget;  // Unused parameter
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
@@ -1070,14 +1441,32 @@ void GTKMinesweeper::on_about(GtkWidget *widget, gpointer user_data) {
     gtk_widget_destroy(dialog);
 }
 
+// Shows the game clock and, while it runs, schedules one wakeup for the
+// moment the displayed second changes. Nothing is scheduled between games,
+// so an idle window never wakes up for the timer.
+void GTKMinesweeper::sync_timer() {
+    if (timer_id > 0) {
+        g_source_remove(timer_id);
+        timer_id = 0;
+    }
+
+    int seconds = game->timer.getElapsedSeconds();
+    if (seconds != shown_seconds) {
+        shown_seconds = seconds;
+        gtk_label_set_text(GTK_LABEL(timer_label), ("Time: " + game->timer.getTimeString()).c_str());
+    }
+
+    if (game->timer.isRunning()) {
+        guint delay = 1000 - game->timer.getElapsedMillis() % 1000;
+        timer_id = g_timeout_add(delay, G_SOURCE_FUNC(update_timer), this);
+    }
+}
+
 gboolean GTKMinesweeper::update_timer(gpointer user_data) {
     GTKMinesweeper *minesweeper = static_cast<GTKMinesweeper*>(user_data);
-    if(!minesweeper->game->gameOver && !minesweeper->game->won && 
-       !minesweeper->game->firstMove) {
-        gtk_label_set_text(GTK_LABEL(minesweeper->timer_label), 
-                        ("Time: " + minesweeper->game->timer.getTimeString()).c_str());
-    }
-    return G_SOURCE_CONTINUE;
+    minesweeper->timer_id = 0;  // This source ends here; sync_timer() adds the next
+    minesweeper->sync_timer();
+    return G_SOURCE_REMOVE;
 }
 
 void GTKMinesweeper::activate(GtkApplication *app, gpointer user_data) {
@@ -3,17 +3,37 @@
 #include <memory>
 #include <vector>
 #include "minesweeper.h"  // Include the base Minesweeper header instead
+#include "minimap.h"
 
 class GTKMinesweeper {
 private:
+    // Images bundled as GResources, in the order of their paths in image()
+    enum Image {
+        IMAGE_FLAG,
+        IMAGE_BOMB,
+        IMAGE_REVEALED,
+        IMAGE_ICON,
+        IMAGE_COUNT
+    };
+
     std::unique_ptr<Minesweeper> game;
     GtkWidget *window;
-    GtkWidget *grid;
+    GtkWidget *board_area;
+    GtkWidget *hscrollbar;
+    GtkWidget *vscrollbar;
+    GtkAdjustment *hadjustment;
+    GtkAdjustment *vadjustment;
+    GtkGesture *zoom_gesture;
+    GtkWidget *minimap_area;
     GtkWidget *timer_label;
     GtkWidget *mines_label;
-    std::vector<std::vector<GtkWidget*>> buttons;
+    GtkWidget *ghost_label;
     GtkWidget *menubar;
     guint timer_id;
+    int shown_seconds;      // Value on timer_label, so unchanged seconds skip the relabel
+    guint ghost_tick_id;
+    GhostRace ghost;
+    std::vector<std::pair<int, int>> ghost_changed;
     
     void show_custom_board_dialog();
     static void on_custom_board(GtkWidget *widget, gpointer user_data);
@@ -22,15 +42,41 @@ private:
     void initialize_grid();
     void update_all_cells();
     void update_cell(int row, int col);
+    void update_changed_cells();
+    void update_layout();
+    void update_origin();
+    void configure_adjustment(GtkAdjustment *adjustment, int board_pixels, int view_pixels);
+    void zoom_at(double factor, double x, double y);
+    void zoom_to_fit();
+    void reset_minimap();
+    void update_minimap(const std::vector<std::pair<int, int>>& cells);
+    void jump_to_minimap(double x, double y);
+    bool cell_at(double x, double y, int &row, int &col) const;
+    int tile_for(int row, int col) const;
+    void build_tile_atlas();
+    void clear_tile_atlas();
+    void render_tile(cairo_t *cr, int tile, double size);
+    void handle_click(int row, int col, guint button);
     void update_mine_counter();
     void show_game_over_dialog();
     void show_win_dialog();
     void show_high_scores();
-    void load_images();
-    void cleanup_images();
-    GdkPixbuf* load_base64_image(const char* base64_data);
+    static GdkPixbuf* image(Image which);
+    static gboolean set_window_icon(gpointer user_data);
     static void activate(GtkApplication *app, gpointer user_data);
-    static void on_button_click(GtkWidget *widget, GdkEventButton *event, gpointer user_data);
+    static gboolean on_board_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data);
+    static gboolean on_board_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data);
+    static gboolean on_board_scroll(GtkWidget *widget, GdkEventScroll *event, gpointer user_data);
+    static void on_board_allocate(GtkWidget *widget, GdkRectangle *allocation, gpointer user_data);
+    static void on_view_scrolled(GtkAdjustment *adjustment, gpointer user_data);
+    static void on_pinch_begin(GtkGesture *gesture, GdkEventSequence *sequence, gpointer user_data);
+    static void on_pinch_scale(GtkGestureZoom *gesture, gdouble scale, gpointer user_data);
+    static void on_zoom_in(GtkWidget *widget, gpointer user_data);
+    static void on_zoom_out(GtkWidget *widget, gpointer user_data);
+    static void on_zoom_fit(GtkWidget *widget, gpointer user_data);
+    static gboolean on_minimap_draw(GtkWidget *widget, cairo_t *cr, gpointer user_data);
+    static gboolean on_minimap_press(GtkWidget *widget, GdkEventButton *event, gpointer user_data);
+    static gboolean on_minimap_motion(GtkWidget *widget, GdkEventMotion *event, gpointer user_data);
     static void on_new_game(GtkWidget *widget, gpointer user_data);
     static void on_reset_game(GtkWidget *widget, gpointer user_data);
     static void on_high_scores(GtkWidget *widget, gpointer user_data);
@@ -41,18 +87,46 @@ private:
     static void on_set_seed(GtkWidget *widget, gpointer user_data);
     static void on_entry_activate(GtkEntry *entry, gpointer user_data);
     void show_seed_dialog();
+    void save_replay();
+    void show_ghost_race_dialog();
+    void start_ghost_race(const std::string& path);
+    void stop_ghost_race();
+    static void on_ghost_race(GtkWidget *widget, gpointer user_data);
+    static gboolean ghost_tick(GtkWidget *widget, GdkFrameClock *clock, gpointer user_data);
+    void sync_timer();
     static gboolean update_timer(gpointer user_data);
 
-    GdkPixbuf *flag_pixbuf;
-    GdkPixbuf *bomb_pixbuf;
-    GdkPixbuf *revealed_pixbuf;
-    GdkPixbuf *app_icon;
+    // Board geometry. The drawing area is only as large as the window;
+    // boards bigger than that are scrolled through the two adjustments,
+    // and board_x/board_y go negative as the view moves right and down.
+    int cell_size;
+    int board_x;
+    int board_y;
+    bool fit_to_view;       // Cell size follows the window until the user zooms
+    int pinch_start_size;   // Cell size when the current pinch began
+    static const int MIN_CELL_SIZE = 4;
+    static const int MAX_CELL_SIZE = 64;
+
+    // Overview of the whole board, shown while it does not fit the view.
+    // The surface wraps one level of the pyramid's pixels without copying.
+    MinimapPyramid minimap;
+    cairo_surface_t *minimap_surface;
+    int minimap_level;
+    int minimap_zoom;       // Screen pixels per pixel of minimap_level
+    static const int MINIMAP_SIZE = 160;
 
-    // Base64 encoded PNG data
-    static const char* FLAG_BASE64;
-    static const char* BOMB_BASE64;
-    static const char* REVEALED_BASE64;
-    static const char* ICON_BASE64;
+    // Every cell appearance, in this order, in one row of tile_atlas
+    enum {
+        TILE_HIDDEN,
+        TILE_GHOST,       // Hidden, but already cleared by the ghost
+        TILE_FLAG,
+        TILE_MINE,
+        TILE_OPEN,        // Revealed with no adjacent mines; TILE_OPEN + n has n
+        TILE_COUNT = TILE_OPEN + 9
+    };
+    cairo_surface_t *tile_atlas;
+    int atlas_cell_size;  // Cell size and scale factor the atlas was built for
+    int atlas_scale;
 
 
 public:
@@ -0,0 +1 @@
+../src/history.cpp
\ No newline at end of file
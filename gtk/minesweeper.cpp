@@ -0,0 +1,262 @@
+#include "minesweeper.h"
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+// GameTimer implementation
+void GameTimer::start() {
+    startTime = std::chrono::steady_clock::now();
+    elapsed = std::chrono::steady_clock::duration::zero();
+    running = true;
+}
+
+void GameTimer::stop() {
+    if (running) {
+        elapsed = std::chrono::steady_clock::now() - startTime;
+        running = false;
+    }
+}
+
+std::chrono::steady_clock::duration GameTimer::current() const {
+    return running ? std::chrono::steady_clock::now() - startTime : elapsed;
+}
+
+uint32_t GameTimer::getElapsedMillis() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(current()).count();
+}
+
+int GameTimer::getElapsedSeconds() const {
+    return std::chrono::duration_cast<std::chrono::seconds>(current()).count();
+}
+
+std::string GameTimer::getTimeString() const {
+    int totalSeconds = getElapsedSeconds();
+    char text[16];
+    snprintf(text, sizeof(text), "%02d:%02d", totalSeconds / 60, totalSeconds % 60);
+    return text;
+}
+
+// Minesweeper implementation
+Minesweeper::Minesweeper() 
+    : height(9)
+    , width(9)
+    , mines(10)
+    , firstMove(true)
+    , gameOver(false)
+    , won(false)
+    , history(highscores.getDirectory())
+    , clicks(0)
+    , revealedCount(0)
+    , flagCount(0)
+    , currentSeed(0) {
+    reset();
+}
+
+void Minesweeper::setDifficulty(Difficulty diff) {
+    const DifficultySettings& settings = DIFFICULTY_SETTINGS[static_cast<int>(diff)];
+    height = settings.height;
+    width = settings.width;
+    mines = settings.mines;
+    reset();
+}
+
+void Minesweeper::reset() {
+    minefield = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
+    revealed = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
+    flagged = std::vector<std::vector<bool>>(height, std::vector<bool>(width, false));
+    revealedCount = 0;
+    flagCount = 0;
+    changedCells.clear();
+    gameOver = false;
+    won = false;
+    firstMove = true;
+    clicks = 0;
+    timer.stop();
+    replay.clear();
+}
+
+void Minesweeper::initializeMinefield(int firstY, int firstX) {
+    std::random_device rd;
+    initializeMinefield(firstY, firstX, static_cast<unsigned int>(rd()));
+}
+
+// Every 32-bit value is a seed of its own; replays record seeds of 2^31 and
+// up as often as any other, so none is reserved to mean "random"
+void Minesweeper::initializeMinefield(int firstY, int firstX, unsigned int seed) {
+    std::mt19937 gen;
+    currentSeed = seed;
+    gen.seed(seed);
+    
+    std::uniform_int_distribution<> disH(0, height - 1);
+    std::uniform_int_distribution<> disW(0, width - 1);
+    
+    int placedMines = 0;
+    while (placedMines < mines) {
+        int y = disH(gen);
+        int x = disW(gen);
+        if (!minefield[y][x] && 
+            (abs(y - firstY) > 1 || abs(x - firstX) > 1)) {
+            minefield[y][x] = true;
+            placedMines++;
+        }
+    }
+
+    ReplayHeader header;
+    header.height = height;
+    header.width = width;
+    header.mines = mines;
+    header.seed = seed;
+    header.firstRow = firstY;
+    header.firstCol = firstX;
+    replay.begin(header);
+}
+
+int Minesweeper::countAdjacentMines(int y, int x) {
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int newY = y + dy;
+            int newX = x + dx;
+            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                if (minefield[newY][newX]) count++;
+            }
+        }
+    }
+    return count;
+}
+
+// Flood fill with an explicit stack, so large openings cannot overflow
+// the call stack
+void Minesweeper::revealCell(int row, int col) {
+    std::vector<std::pair<int, int>> pending;
+    pending.emplace_back(row, col);
+    while (!pending.empty()) {
+        int y = pending.back().first;
+        int x = pending.back().second;
+        pending.pop_back();
+        if (y < 0 || y >= height || x < 0 || x >= width ||
+            revealed[y][x] || flagged[y][x])
+            continue;
+
+        revealed[y][x] = true;
+        changedCells.emplace_back(y, x);
+        if (!minefield[y][x]) revealedCount++;
+
+        if (countAdjacentMines(y, x) == 0) {
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    pending.emplace_back(y + dy, x + dx);
+                }
+            }
+        }
+    }
+}
+
+void Minesweeper::toggleFlag(int row, int col) {
+    flagged[row][col] = !flagged[row][col];
+    flagCount += flagged[row][col] ? 1 : -1;
+    changedCells.emplace_back(row, col);
+}
+
+void Minesweeper::revealAllMines() {
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (minefield[y][x] && !revealed[y][x]) {
+                revealed[y][x] = true;
+                changedCells.emplace_back(y, x);
+            }
+        }
+    }
+}
+
+bool Minesweeper::checkWin() {
+    return revealedCount == width * height - mines;
+}
+
+bool Minesweeper::isHighScore(int timeMs) {
+    // Custom boards have their own leaderboard per width, height and mines
+    return highscores.isHighScore(timeMs, width, height, mines);
+}
+
+void Minesweeper::saveHighscore() {
+    Score score;
+    score.name = playerName;
+    score.timeMs = timer.getElapsedMillis();
+    score.difficulty = Highscores::boardName(width, height, mines);
+    highscores.addScore(score);
+}
+
+void Minesweeper::recordGame(GameOutcome outcome) {
+    GameRecord game;
+    game.board = Highscores::packBoard(width, height, mines);
+    game.timeMs = timer.getElapsedMillis();
+    game.bbbv = count3BV(minefield);
+    game.clicks = clicks;
+    game.outcome = outcome;
+    game.date = static_cast<uint32_t>(std::time(nullptr));
+    history.record(game);
+}
+
+void Minesweeper::recordMove(MoveType type, int row, int col) {
+    clicks++;
+    replay.record(timer.getElapsedMillis(), type, row, col);
+}
+
+int Minesweeper::countAdjacentFlags(int y, int x) {
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int newY = y + dy;
+            int newX = x + dx;
+            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                if (flagged[newY][newX]) count++;
+            }
+        }
+    }
+    return count;
+}
+
+void Minesweeper::revealAdjacent(int y, int x) {
+    if (!revealed[y][x]) return;
+
+    int mineCount = countAdjacentMines(y, x);
+    int flagCount = countAdjacentFlags(y, x);
+
+    if (mineCount == flagCount) {
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int newY = y + dy;
+                int newX = x + dx;
+                if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                    if (!flagged[newY][newX] && !revealed[newY][newX]) {
+                        if (minefield[newY][newX]) {
+                            gameOver = true;
+                            revealAllMines();
+                            timer.stop();
+                            return;
+                        }
+                        revealCell(newY, newX);
+                    }
+                }
+            }
+        }
+        if (checkWin()) {
+            won = true;
+            timer.stop();
+        }
+    }
+}
+
+void Minesweeper::resetWithSeed() {
+    reset();  // Do regular reset first
+    
+    // If we have a valid seed from a previous game
+    if (currentSeed != 0) {
+        // Reinitialize the minefield with the same seed
+        initializeMinefield(0, 0, currentSeed);
+        // We don't want the first move protection since we're recreating a specific board
+        firstMove = false;
+        timer.start();
+    }
+}
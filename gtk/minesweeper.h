@@ -1,8 +1,12 @@
 #pragma once
 #include <string>
 #include <vector>
+#include <utility>
 #include <chrono>
+#include <cstdint>
 #include "highscores.h"
+#include "history.h"
+#include "replay.h"
 
 enum class Difficulty {
     EASY,    // 9x9, 10 mines
@@ -22,17 +26,23 @@ const DifficultySettings DIFFICULTY_SETTINGS[] = {
     {16, 30, 99}   // HARD
 };
 
+// Monotonic game clock. The full steady_clock resolution is kept and only
+// rounded down when read, so scores are exact to the millisecond.
 class GameTimer {
 private:
     std::chrono::steady_clock::time_point startTime;
-    bool running;
-    int elapsedSeconds;
+    std::chrono::steady_clock::duration elapsed{};
+    bool running = false;
+
+    std::chrono::steady_clock::duration current() const;
 
 public:
     void start();
     void stop();
+    bool isRunning() const { return running; }
     std::string getTimeString() const;
     int getElapsedSeconds() const;
+    uint32_t getElapsedMillis() const;
 };
 
 class Minesweeper {
@@ -44,22 +54,34 @@ public:
     std::string playerName;
     GameTimer timer;
     Highscores highscores;
+    GameHistory history;  // Declared after highscores, whose directory it shares
+    int clicks;
     std::vector<std::vector<bool>> minefield;
     std::vector<std::vector<bool>> revealed;
     std::vector<std::vector<bool>> flagged;
+    int revealedCount;  // Safe cells revealed so far
+    int flagCount;
+    // Cells whose appearance changed since the front-end last took them;
+    // each action adds exactly the cells it touched
+    std::vector<std::pair<int, int>> changedCells;
     void revealAdjacent(int y, int x);
-    int currentSeed;
+    unsigned int currentSeed;
+    ReplayRecorder replay;
     int countAdjacentFlags(int, int);
     void resetWithSeed();
 
     Minesweeper();
     void setDifficulty(Difficulty diff);
     void reset();
-    void initializeMinefield(int row, int col, int seed);
+    void initializeMinefield(int row, int col);  // With a random seed
+    void initializeMinefield(int row, int col, unsigned int seed);
     int countAdjacentMines(int row, int col);
     void revealCell(int row, int col);
+    void toggleFlag(int row, int col);
     void revealAllMines();
     bool checkWin();
-    bool isHighScore(int time, const std::string& difficulty);
+    bool isHighScore(int timeMs);
     void saveHighscore();
+    void recordMove(MoveType type, int row, int col);
+    void recordGame(GameOutcome outcome);
 };
@@ -0,0 +1,85 @@
+#include "minimap.h"
+#include <algorithm>
+
+namespace {
+    // Opaque ARGB, in CellState order
+    const uint32_t STATE_COLORS[] = {
+        0xFFA0A0A0,  // Hidden
+        0xFFF0F0F0,  // Open
+        0xFFE02020,  // Flagged
+        0xFF000000   // Mine
+    };
+}
+
+void MinimapPyramid::reset(int width, int height) {
+    images.clear();
+    dirty.clear();
+    widths.clear();
+    heights.clear();
+    for (;;) {
+        widths.push_back(width);
+        heights.push_back(height);
+        images.emplace_back(static_cast<size_t>(width) * height, STATE_COLORS[HIDDEN]);
+        if (width == 1 && height == 1) break;
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+}
+
+void MinimapPyramid::set(int row, int col, CellState state) {
+    uint32_t& cell = images[0][static_cast<size_t>(row) * widths[0] + col];
+    if (cell == STATE_COLORS[state]) return;
+    cell = STATE_COLORS[state];
+    if (levels() > 1) {
+        dirty.push_back(static_cast<size_t>(row / 2) * widths[1] + col / 2);
+    }
+}
+
+// Blends the dirty pixels one level at a time, so a parent shared by many
+// changed cells is recomputed once
+void MinimapPyramid::commit() {
+    std::vector<size_t> next;
+    for (int level = 1; level < levels() && !dirty.empty(); level++) {
+        std::sort(dirty.begin(), dirty.end());
+        dirty.erase(std::unique(dirty.begin(), dirty.end()), dirty.end());
+        next.clear();
+        for (size_t index : dirty) {
+            int row = static_cast<int>(index / widths[level]);
+            int col = static_cast<int>(index % widths[level]);
+            images[level][index] = blend(level, row, col);
+            if (level + 1 < levels()) {
+                next.push_back(static_cast<size_t>(row / 2) * widths[level + 1] + col / 2);
+            }
+        }
+        dirty.swap(next);
+    }
+    dirty.clear();
+}
+
+// Averages the pixels of the level below that this pixel covers; at odd
+// edges there are fewer than four
+uint32_t MinimapPyramid::blend(int level, int row, int col) const {
+    const std::vector<uint32_t>& below = images[level - 1];
+    int belowWidth = widths[level - 1];
+    int belowHeight = heights[level - 1];
+    uint32_t red = 0, green = 0, blue = 0, count = 0;
+    for (int y = row * 2; y < row * 2 + 2 && y < belowHeight; y++) {
+        for (int x = col * 2; x < col * 2 + 2 && x < belowWidth; x++) {
+            uint32_t pixel = below[static_cast<size_t>(y) * belowWidth + x];
+            red += (pixel >> 16) & 0xFF;
+            green += (pixel >> 8) & 0xFF;
+            blue += pixel & 0xFF;
+            count++;
+        }
+    }
+    return 0xFF000000 | (red / count) << 16 | (green / count) << 8 | (blue / count);
+}
+
+int MinimapPyramid::levelFitting(int maxWidth, int maxHeight) const {
+    for (int level = 0; level < levels(); level++) {
+        if (widths[level] <= maxWidth && heights[level] <= maxHeight) {
+            return level;
+        }
+    }
+    return levels() - 1;
+}
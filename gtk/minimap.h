@@ -0,0 +1,45 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Downsampled picture of the board for the minimap, kept as a mip pyramid
+// of ARGB32 images. Level 0 has one pixel per cell; each level above halves
+// both sides, and a pixel there is the average colour of the (up to) 2x2
+// pixels beneath it. Only the pixels above changed cells are recomputed, a
+// few dozen per cell for a single move and about a third of the opened
+// area for a large flood. Only reset() touches every pixel.
+class MinimapPyramid {
+public:
+    enum CellState : uint8_t {
+        HIDDEN,
+        OPEN,
+        FLAGGED,
+        MINE
+    };
+
+    // Starts a new board with every cell hidden
+    void reset(int width, int height);
+    // Changes reach the coarser levels on the next commit()
+    void set(int row, int col, CellState state);
+    void commit();
+
+    int levels() const { return static_cast<int>(images.size()); }
+    int width(int level) const { return widths[level]; }
+    int height(int level) const { return heights[level]; }
+
+    // Rows of width(level) packed native-endian ARGB32 pixels, as Cairo
+    // expects. The buffer stays in place until the next reset().
+    uint32_t* pixels(int level) { return images[level].data(); }
+
+    // Finest level no larger than maxWidth x maxHeight
+    int levelFitting(int maxWidth, int maxHeight) const;
+
+private:
+    uint32_t blend(int level, int row, int col) const;
+
+    std::vector<std::vector<uint32_t>> images;
+    std::vector<int> widths;
+    std::vector<int> heights;
+    std::vector<size_t> dirty;  // Pixels of the next level up that need blending
+};
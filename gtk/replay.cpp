@@ -0,0 +1,313 @@
+#include "replay.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const char REPLAY_MAGIC[4] = {'M', 'S', 'R', 'P'};
+    const uint8_t REPLAY_VERSION = 1;
+    const size_t HEADER_SIZE = 4 + 1 + 2 + 2 + 4 + 4 + 2 + 2;
+
+    // The custom board dialog's limits; a replay is raced on a board built
+    // from its header, so nothing outside them is accepted
+    const int MIN_SIDE = 8;
+    const int MAX_SIDE = 2000;
+
+    void putLE(std::vector<uint8_t>& out, uint32_t value, int bytes) {
+        for (int i = 0; i < bytes; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+
+    uint32_t getLE(const uint8_t* in, int bytes) {
+        uint32_t value = 0;
+        for (int i = 0; i < bytes; i++) {
+            value |= static_cast<uint32_t>(in[i]) << (8 * i);
+        }
+        return value;
+    }
+}
+
+// ReplayRecorder implementation
+void ReplayRecorder::begin(const ReplayHeader& replayHeader) {
+    header = replayHeader;
+    moves.clear();
+    lastTimeMs = 0;
+    active = true;
+}
+
+void ReplayRecorder::record(uint32_t timeMs, MoveType type, int row, int col) {
+    if (!active) return;
+    if (timeMs < lastTimeMs) timeMs = lastTimeMs;
+    putVarint(timeMs - lastTimeMs);
+    putVarint(static_cast<uint32_t>(row * header.width + col));
+    moves.push_back(static_cast<uint8_t>(type));
+    lastTimeMs = timeMs;
+}
+
+void ReplayRecorder::clear() {
+    moves.clear();
+    lastTimeMs = 0;
+    active = false;
+}
+
+bool ReplayRecorder::empty() const {
+    return !active || moves.empty();
+}
+
+bool ReplayRecorder::save(const std::string& path) const {
+    if (!active) return false;
+
+    std::vector<uint8_t> out;
+    out.reserve(HEADER_SIZE + moves.size());
+    out.insert(out.end(), REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    out.push_back(REPLAY_VERSION);
+    putLE(out, header.height, 2);
+    putLE(out, header.width, 2);
+    putLE(out, header.mines, 4);
+    putLE(out, header.seed, 4);
+    putLE(out, header.firstRow, 2);
+    putLE(out, header.firstCol, 2);
+    out.insert(out.end(), moves.begin(), moves.end());
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(out.data()), out.size());
+    return static_cast<bool>(file);
+}
+
+void ReplayRecorder::putVarint(uint32_t value) {
+    while (value >= 0x80) {
+        moves.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    moves.push_back(static_cast<uint8_t>(value));
+}
+
+// ReplayDecoder implementation
+bool ReplayDecoder::open(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (data.size() < HEADER_SIZE ||
+        !std::equal(REPLAY_MAGIC, REPLAY_MAGIC + 4, data.begin()) ||
+        data[4] != REPLAY_VERSION) {
+        data.clear();
+        return false;
+    }
+
+    const uint8_t* p = data.data() + 5;
+    header.height = getLE(p, 2);
+    header.width = getLE(p + 2, 2);
+    header.mines = getLE(p + 4, 4);
+    header.seed = getLE(p + 8, 4);
+    header.firstRow = getLE(p + 12, 2);
+    header.firstCol = getLE(p + 14, 2);
+    // Mines beyond width * height - 9 could never all be placed outside the
+    // first click's 3x3, and placing them would never finish
+    if (header.height < MIN_SIDE || header.height > MAX_SIDE ||
+        header.width < MIN_SIDE || header.width > MAX_SIDE ||
+        header.mines < 1 || header.mines > header.width * header.height - 9 ||
+        header.firstRow >= header.height || header.firstCol >= header.width) {
+        data.clear();
+        return false;
+    }
+
+    cursor = HEADER_SIZE;
+    clockMs = 0;
+    pending = false;
+    return true;
+}
+
+bool ReplayDecoder::peek(ReplayEvent& event) {
+    if (pending) {
+        event = pendingEvent;
+        return true;
+    }
+
+    size_t pos = cursor;
+    uint32_t delta, cell;
+    if (!getVarint(pos, delta) || !getVarint(pos, cell) || pos >= data.size()) {
+        return false;
+    }
+    uint8_t type = data[pos++];
+    if (type > static_cast<uint8_t>(MoveType::CHORD) ||
+        cell >= static_cast<uint32_t>(header.height * header.width)) {
+        return false;
+    }
+
+    pendingEvent.timeMs = clockMs + delta;
+    pendingEvent.row = cell / header.width;
+    pendingEvent.col = cell % header.width;
+    pendingEvent.type = static_cast<MoveType>(type);
+    pendingEnd = pos;
+    pending = true;
+    event = pendingEvent;
+    return true;
+}
+
+void ReplayDecoder::consume() {
+    if (!pending) return;
+    cursor = pendingEnd;
+    clockMs = pendingEvent.timeMs;
+    pending = false;
+}
+
+bool ReplayDecoder::finished() const {
+    return !pending && cursor >= data.size();
+}
+
+bool ReplayDecoder::getVarint(size_t& pos, uint32_t& value) const {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (pos >= data.size()) return false;
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// GhostRace implementation
+bool GhostRace::start(const std::string& path) {
+    stop();
+    if (!decoder.open(path)) return false;
+    active = true;
+    return true;
+}
+
+void GhostRace::stop() {
+    active = false;
+    finished = false;
+    finishMs = 0;
+    minefield = nullptr;
+    revealed.clear();
+    flagged.clear();
+}
+
+void GhostRace::attach(const std::vector<std::vector<bool>>* board) {
+    minefield = board;
+    height = decoder.getHeader().height;
+    width = decoder.getHeader().width;
+    revealed.assign(height * width, 0);
+    flagged.assign(height * width, 0);
+    remainingSafe = height * width - decoder.getHeader().mines;
+    finished = false;
+    finishMs = 0;
+}
+
+void GhostRace::advance(uint32_t nowMs, std::vector<std::pair<int, int>>& changed) {
+    if (!active || finished || !minefield) return;
+
+    ReplayEvent event;
+    while (decoder.peek(event) && event.timeMs <= nowMs) {
+        decoder.consume();
+        switch (event.type) {
+            case MoveType::REVEAL:
+                reveal(event.row, event.col, changed);
+                break;
+            case MoveType::FLAG:
+                flagged[event.row * width + event.col] ^= 1;
+                break;
+            case MoveType::CHORD:
+                chord(event.row, event.col, changed);
+                break;
+        }
+        if (remainingSafe <= 0 || finished) {
+            finished = true;
+            finishMs = event.timeMs;
+            return;
+        }
+    }
+    if (decoder.finished()) {
+        finished = true;
+        finishMs = nowMs;
+    }
+}
+
+bool GhostRace::isRevealed(int row, int col) const {
+    if (!active || revealed.empty()) return false;
+    return revealed[row * width + col] != 0;
+}
+
+void GhostRace::reveal(int row, int col, std::vector<std::pair<int, int>>& changed) {
+    const auto& mines = *minefield;
+    int start = row * width + col;
+    if (revealed[start] || flagged[start]) return;
+    if (mines[row][col]) {
+        // The ghost stepped on a mine; its run ends here
+        finished = true;
+        return;
+    }
+
+    // Iterative flood fill so a large opening cannot exhaust the stack
+    stack.clear();
+    stack.push_back(start);
+    revealed[start] = 1;
+    while (!stack.empty()) {
+        int cell = stack.back();
+        stack.pop_back();
+        int y = cell / width;
+        int x = cell % width;
+        changed.emplace_back(y, x);
+        remainingSafe--;
+
+        if (adjacentMines(y, x) != 0) continue;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int newY = y + dy;
+                int newX = x + dx;
+                if (newY < 0 || newY >= height || newX < 0 || newX >= width) continue;
+                int next = newY * width + newX;
+                if (!revealed[next] && !flagged[next] && !mines[newY][newX]) {
+                    revealed[next] = 1;
+                    stack.push_back(next);
+                }
+            }
+        }
+    }
+}
+
+void GhostRace::chord(int row, int col, std::vector<std::pair<int, int>>& changed) {
+    if (!revealed[row * width + col]) return;
+
+    // Like the player's board, a chord only opens cells once the number's
+    // mines are all flagged; otherwise it does nothing
+    int flags = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int newY = row + dy;
+            int newX = col + dx;
+            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                flags += flagged[newY * width + newX];
+            }
+        }
+    }
+    if (flags != adjacentMines(row, col)) return;
+
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int newY = row + dy;
+            int newX = col + dx;
+            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                reveal(newY, newX, changed);
+            }
+        }
+    }
+}
+
+int GhostRace::adjacentMines(int row, int col) const {
+    const auto& mines = *minefield;
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int newY = row + dy;
+            int newX = col + dx;
+            if (newY >= 0 && newY < height && newX >= 0 && newX < width) {
+                if (mines[newY][newX]) count++;
+            }
+        }
+    }
+    return count;
+}
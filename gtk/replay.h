@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Replay file layout (all integers little-endian):
+//   "MSRP" magic, u8 version, u16 height, u16 width, u32 mines,
+//   u32 seed, u16 firstRow, u16 firstCol
+// followed by one record per move:
+//   varint timeDelta (ms since previous move), varint cell (row * width + col),
+//   u8 move type
+// Records are only ever appended, so a replay can be decoded as a stream.
+
+enum class MoveType : uint8_t {
+    REVEAL = 0,
+    FLAG = 1,
+    CHORD = 2
+};
+
+struct ReplayHeader {
+    int height = 0;
+    int width = 0;
+    int mines = 0;
+    unsigned int seed = 0;
+    int firstRow = 0;
+    int firstCol = 0;
+};
+
+struct ReplayEvent {
+    uint32_t timeMs;
+    int row;
+    int col;
+    MoveType type;
+};
+
+class ReplayRecorder {
+public:
+    void begin(const ReplayHeader& header);
+    void record(uint32_t timeMs, MoveType type, int row, int col);
+    void clear();
+    bool empty() const;
+    bool save(const std::string& path) const;
+
+private:
+    void putVarint(uint32_t value);
+
+    ReplayHeader header;
+    std::vector<uint8_t> moves;
+    uint32_t lastTimeMs = 0;
+    bool active = false;
+};
+
+class ReplayDecoder {
+public:
+    bool open(const std::string& path);
+    const ReplayHeader& getHeader() const { return header; }
+
+    // Decodes the next move without consuming it. Returns false at the end
+    // of the stream or on a truncated record.
+    bool peek(ReplayEvent& event);
+    void consume();
+    bool finished() const;
+
+private:
+    bool getVarint(size_t& pos, uint32_t& value) const;
+
+    ReplayHeader header;
+    std::vector<uint8_t> data;
+    size_t cursor = 0;
+    uint32_t clockMs = 0;
+    bool pending = false;
+    size_t pendingEnd = 0;
+    ReplayEvent pendingEvent{};
+};
+
+// Plays a replay against the player's board and tracks which cells the ghost
+// has uncovered. Only cells whose ghost state changed since the last call to
+// advance() are reported, so the caller can repaint exactly those.
+class GhostRace {
+public:
+    bool start(const std::string& path);
+    void stop();
+    bool isActive() const { return active; }
+    const ReplayHeader& getHeader() const { return decoder.getHeader(); }
+
+    void attach(const std::vector<std::vector<bool>>* minefield);
+    void advance(uint32_t nowMs, std::vector<std::pair<int, int>>& changed);
+    bool isRevealed(int row, int col) const;
+    bool isFinished() const { return finished; }
+    bool hasCleared() const { return remainingSafe <= 0; }
+    uint32_t getFinishMs() const { return finishMs; }
+
+private:
+    void reveal(int row, int col, std::vector<std::pair<int, int>>& changed);
+    void chord(int row, int col, std::vector<std::pair<int, int>>& changed);
+    int adjacentMines(int row, int col) const;
+
+    ReplayDecoder decoder;
+    const std::vector<std::vector<bool>>* minefield = nullptr;
+    std::vector<uint8_t> revealed;
+    std::vector<uint8_t> flagged;
+    std::vector<int> stack;
+    int height = 0;
+    int width = 0;
+    int remainingSafe = 0;
+    uint32_t finishMs = 0;
+    bool active = false;
+    bool finished = false;
+};
@@ -0,0 +1,156 @@
+// Plays a game, saves its replay, and races it as a ghost: the board the race
+// rebuilds from the replay header has to be the board that was played.
+// Needs no GTK; run it with "make test".
+#include "minesweeper.h"
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+namespace {
+    int failures = 0;
+
+    void check(bool ok, const char* what) {
+        if (!ok) {
+            std::fprintf(stderr, "FAIL: %s\n", what);
+            failures++;
+        }
+    }
+
+    // Above INT_MAX, where a seed used to be read as "choose a random one"
+    const unsigned int HIGH_SEED = 0x80000001u;
+
+    void testHighSeedRoundTrip(const std::string& path) {
+        Minesweeper played;
+        played.setDifficulty(Difficulty::HARD);
+        played.initializeMinefield(8, 15, HIGH_SEED);
+        played.firstMove = false;
+        played.timer.start();
+        played.recordMove(MoveType::REVEAL, 8, 15);
+        played.revealCell(8, 15);
+        check(played.replay.save(path), "replay saved");
+
+        GhostRace ghost;
+        check(ghost.start(path), "replay opened");
+        const ReplayHeader& header = ghost.getHeader();
+        check(header.seed == HIGH_SEED, "seed kept by the replay file");
+
+        Minesweeper raced;
+        raced.height = header.height;
+        raced.width = header.width;
+        raced.mines = header.mines;
+        raced.reset();
+        raced.initializeMinefield(header.firstRow, header.firstCol, header.seed);
+        check(raced.currentSeed == HIGH_SEED, "race uses the recorded seed");
+        check(raced.minefield == played.minefield, "race board matches the played board");
+
+        ghost.attach(&raced.minefield);
+        std::vector<std::pair<int, int>> changed;
+        ghost.advance(UINT32_MAX, changed);
+        bool same = true;
+        for (int row = 0; row < played.height; row++) {
+            for (int col = 0; col < played.width; col++) {
+                same = same && ghost.isRevealed(row, col) == played.revealed[row][col];
+            }
+        }
+        check(same, "ghost reveals the cells the player did");
+    }
+
+    // A chord on a number whose mines are not all flagged opens nothing, so
+    // a ghost that replays one must not step on the unflagged mine. The move
+    // is written straight into the replay, as earlier builds recorded it.
+    void testUnderflaggedChord(const std::string& path) {
+        Minesweeper played;
+        played.initializeMinefield(4, 4, 42);
+        played.firstMove = false;
+        played.timer.start();
+        played.recordMove(MoveType::REVEAL, 4, 4);
+        played.revealCell(4, 4);
+
+        int numberRow = -1;
+        int numberCol = -1;
+        for (int row = 0; row < played.height && numberRow < 0; row++) {
+            for (int col = 0; col < played.width; col++) {
+                if (played.revealed[row][col] && played.countAdjacentMines(row, col) > 0) {
+                    numberRow = row;
+                    numberCol = col;
+                    break;
+                }
+            }
+        }
+        check(numberRow >= 0, "first reveal shows a number");
+        played.recordMove(MoveType::CHORD, numberRow, numberCol);
+        played.revealAdjacent(numberRow, numberCol);
+        check(!played.gameOver, "under-flagged chord opens nothing");
+
+        // Then win by revealing every other safe cell
+        for (int row = 0; row < played.height; row++) {
+            for (int col = 0; col < played.width; col++) {
+                if (!played.minefield[row][col] && !played.revealed[row][col]) {
+                    played.recordMove(MoveType::REVEAL, row, col);
+                    played.revealCell(row, col);
+                }
+            }
+        }
+        check(played.checkWin(), "player clears the board");
+        check(played.replay.save(path), "replay saved");
+
+        GhostRace ghost;
+        check(ghost.start(path), "replay opened");
+        ghost.attach(&played.minefield);
+        std::vector<std::pair<int, int>> changed;
+        ghost.advance(UINT32_MAX, changed);
+        check(ghost.isFinished() && ghost.hasCleared(), "ghost clears the board too");
+    }
+
+    // Writes a replay header with the given fields and no moves
+    void writeHeader(const std::string& path, uint32_t height, uint32_t width, uint32_t mines,
+                     uint32_t firstRow, uint32_t firstCol) {
+        std::string out = "MSRP";
+        out.push_back(1);
+        const uint32_t fields[] = {height, width, mines, 42, firstRow, firstCol};
+        const int sizes[] = {2, 2, 4, 4, 2, 2};
+        for (int field = 0; field < 6; field++) {
+            for (int i = 0; i < sizes[field]; i++) {
+                out.push_back(static_cast<char>(fields[field] >> (8 * i)));
+            }
+        }
+        std::ofstream(path, std::ios::binary) << out;
+    }
+
+    bool opens(const std::string& path, uint32_t height, uint32_t width, uint32_t mines,
+               uint32_t firstRow, uint32_t firstCol) {
+        writeHeader(path, height, width, mines, firstRow, firstCol);
+        ReplayDecoder decoder;
+        return decoder.open(path);
+    }
+
+    // A replay's header becomes the raced board, so headers outside the
+    // custom board limits must be refused before anything is allocated or
+    // any mine placed
+    void testHeaderLimits(const std::string& path) {
+        check(opens(path, 16, 30, 99, 8, 15), "valid header opens");
+        check(opens(path, 8, 2000, 8 * 2000 - 9, 0, 1999), "largest mine count opens");
+        check(!opens(path, 7, 30, 10, 0, 0), "height below 8 refused");
+        check(!opens(path, 16, 2001, 10, 0, 0), "width above 2000 refused");
+        check(!opens(path, 65535, 65535, 10, 0, 0), "huge board refused");
+        check(!opens(path, 16, 30, 0, 0, 0), "no mines refused");
+        check(!opens(path, 16, 30, 16 * 30 - 8, 0, 0), "mines filling the 3x3 refused");
+        check(!opens(path, 16, 30, 0xFFFFFFFF, 0, 0), "negative mine count refused");
+        check(!opens(path, 16, 30, 99, 16, 0), "first row off the board refused");
+        check(!opens(path, 16, 30, 99, 0, 30), "first column off the board refused");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::string path = argc > 1 ? argv[1] : "replay_test.msrp";
+    testHighSeedRoundTrip(path);
+    testUnderflaggedChord(path);
+    testHeaderLimits(path);
+    std::remove(path.c_str());
+
+    if (failures == 0) {
+        std::printf("All replay tests passed\n");
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// C interface over Board. Nothing here may let a C++ exception reach the
+// caller, and the handle is the Board itself so a game costs no more than
+// it does inside the terminal version.
+#define MS_BUILDING_LIBRARY
+#include "libminesweeper.h"
+#include "board.h"
+#include <new>
+
+struct ms_game {
+    Board board;
+};
+
+namespace {
+    int statusOf(const Board& board) {
+        return static_cast<int>(board.status());
+    }
+
+    int play(ms_game* game, int kind, int row, int col) {
+        if (!game) return MS_ERROR_ARGUMENT;
+        Board& board = game->board;
+        if (!board.contains(row, col)) return MS_ERROR_OFF_BOARD;
+        switch (kind) {
+        case MS_REVEAL:
+            board.reveal(row, col);
+            break;
+        case MS_FLAG:
+            board.toggleFlag(row, col);
+            break;
+        case MS_CHORD:
+            board.chord(row, col);
+            break;
+        default:
+            return MS_ERROR_ARGUMENT;
+        }
+        return statusOf(board);
+    }
+}
+
+extern "C" {
+
+int ms_api_version(void) {
+    return MS_API_VERSION;
+}
+
+// Board keeps the seed as an int; the cast round-trips every 32-bit value,
+// and std::mt19937 only looks at the low 32 bits of what it is seeded with
+ms_game* ms_create(int width, int height, int mines, uint32_t seed) {
+    if (width < MS_MIN_SIDE || width > MS_MAX_SIDE || height < MS_MIN_SIDE ||
+        height > MS_MAX_SIDE || mines < 1 || mines > width * height - 9) {
+        return nullptr;
+    }
+    try {
+        return new ms_game{Board(width, height, mines, static_cast<int>(seed))};
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void ms_destroy(ms_game* game) {
+    delete game;
+}
+
+int ms_reset(ms_game* game) {
+    if (!game) return MS_ERROR_ARGUMENT;
+    game->board.reset();
+    return MS_PLAYING;
+}
+
+int ms_set_seed(ms_game* game, uint32_t seed) {
+    if (!game) return MS_ERROR_ARGUMENT;
+    if (game->board.minesPlaced()) return MS_ERROR_PLACED;
+    game->board.setSeed(static_cast<int>(seed));
+    return statusOf(game->board);
+}
+
+uint32_t ms_seed(const ms_game* game) {
+    return game ? static_cast<uint32_t>(game->board.seed()) : 0;
+}
+
+int ms_reveal(ms_game* game, int row, int col) {
+    return play(game, MS_REVEAL, row, col);
+}
+
+int ms_flag(ms_game* game, int row, int col) {
+    return play(game, MS_FLAG, row, col);
+}
+
+int ms_chord(ms_game* game, int row, int col) {
+    return play(game, MS_CHORD, row, col);
+}
+
+int ms_apply(ms_game* game, const ms_move* moves, size_t count, size_t* applied) {
+    size_t done = 0;
+    int result = game ? statusOf(game->board) : MS_ERROR_ARGUMENT;
+    if (game && count > 0 && !moves) {
+        result = MS_ERROR_ARGUMENT;
+    }
+    while (result >= 0 && done < count) {
+        result = play(game, moves[done].kind, moves[done].row, moves[done].col);
+        if (result >= 0) done++;
+    }
+    if (applied) *applied = done;
+    return result;
+}
+
+int ms_status(const ms_game* game) {
+    return game ? statusOf(game->board) : MS_ERROR_ARGUMENT;
+}
+
+int ms_width(const ms_game* game) {
+    return game ? game->board.width() : MS_ERROR_ARGUMENT;
+}
+
+int ms_height(const ms_game* game) {
+    return game ? game->board.height() : MS_ERROR_ARGUMENT;
+}
+
+int ms_mines(const ms_game* game) {
+    return game ? game->board.mines() : MS_ERROR_ARGUMENT;
+}
+
+int ms_revealed(const ms_game* game) {
+    return game ? game->board.revealedSafe() : MS_ERROR_ARGUMENT;
+}
+
+int ms_flags(const ms_game* game) {
+    return game ? game->board.flags() : MS_ERROR_ARGUMENT;
+}
+
+size_t ms_read_state(const ms_game* game, uint8_t* buffer, size_t size) {
+    if (!game) return 0;
+    const Board& board = game->board;
+    size_t needed = static_cast<size_t>(board.width()) * board.height();
+    if (!buffer || size < needed) return needed;
+    for (int row = 0; row < board.height(); row++) {
+        for (int col = 0; col < board.width(); col++) {
+            uint8_t cell;
+            if (board.isFlagged(row, col)) {
+                cell = MS_CELL_FLAGGED;
+            } else if (!board.isRevealed(row, col)) {
+                cell = MS_CELL_HIDDEN;
+            } else if (board.isMine(row, col)) {
+                cell = MS_CELL_MINE;
+            } else {
+                cell = static_cast<uint8_t>(board.adjacentMines(row, col));
+            }
+            *buffer++ = cell;
+        }
+    }
+    return needed;
+}
+
+}
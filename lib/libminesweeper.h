@@ -0,0 +1,131 @@
+#ifndef LIBMINESWEEPER_H
+#define LIBMINESWEEPER_H
+
+/*
+ * libminesweeper: the game engine of the terminal version behind a plain C
+ * interface, for programs in other languages that want to play many games
+ * in one process.
+ *
+ * The interface is stable: functions and values are only ever added, and
+ * ms_api_version() goes up when they are. A game is an opaque handle. Games
+ * are independent, so different games may be used from different threads,
+ * but one game must not be used from two threads at once.
+ *
+ * Mines are placed from the seed on the first reveal, never in the 3x3
+ * around it, so a seed and a first click always give the same board, the
+ * same board the terminal version gives for that seed. Rows and columns
+ * count from 0.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(MS_BUILDING_LIBRARY)
+#define MS_API __declspec(dllexport)
+#else
+#define MS_API __declspec(dllimport)
+#endif
+#elif defined(__GNUC__)
+#define MS_API __attribute__((visibility("default")))
+#else
+#define MS_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MS_API_VERSION 1
+#define MS_MIN_SIDE 5
+#define MS_MAX_SIDE 5000
+
+typedef struct ms_game ms_game;
+
+/* Game status */
+enum {
+    MS_PLAYING = 0,
+    MS_WON = 1,
+    MS_LOST = 2
+};
+
+/* Errors; every function returning int returns one of these when it fails */
+enum {
+    MS_ERROR_ARGUMENT = -1, /* Null game, bad move kind or size */
+    MS_ERROR_OFF_BOARD = -2,
+    MS_ERROR_PLACED = -3 /* The seed can no longer change */
+};
+
+/* Moves */
+enum {
+    MS_REVEAL = 0,
+    MS_FLAG = 1, /* Toggles the flag */
+    MS_CHORD = 2
+};
+
+/* Cells as ms_read_state() writes them: 0-8 is a revealed number */
+enum {
+    MS_CELL_HIDDEN = 9,
+    MS_CELL_FLAGGED = 10,
+    MS_CELL_MINE = 11
+};
+
+typedef struct ms_move {
+    int32_t kind; /* MS_REVEAL, MS_FLAG or MS_CHORD */
+    int32_t row;
+    int32_t col;
+} ms_move;
+
+MS_API int ms_api_version(void);
+
+/*
+ * Width and height from MS_MIN_SIDE to MS_MAX_SIDE, and from 1 to
+ * width * height - 9 mines. Returns NULL if they are out of range or
+ * memory runs out.
+ */
+MS_API ms_game *ms_create(int width, int height, int mines, uint32_t seed);
+MS_API void ms_destroy(ms_game *game);
+
+/* Starts the game over, keeping its size and seed and its memory */
+MS_API int ms_reset(ms_game *game);
+/* Only before the first reveal, which is when the mines are placed */
+MS_API int ms_set_seed(ms_game *game, uint32_t seed);
+MS_API uint32_t ms_seed(const ms_game *game);
+
+/*
+ * Each returns the game status after the move. A move that changes nothing,
+ * such as revealing a flagged cell or any move once the game is over, is not
+ * an error.
+ */
+MS_API int ms_reveal(ms_game *game, int row, int col);
+MS_API int ms_flag(ms_game *game, int row, int col);
+MS_API int ms_chord(ms_game *game, int row, int col);
+
+/*
+ * Plays count moves in order and returns the status after them. Stops at
+ * the first invalid move and returns its error. If applied is not NULL it
+ * receives the number of moves played before stopping.
+ */
+MS_API int ms_apply(ms_game *game, const ms_move *moves, size_t count,
+                    size_t *applied);
+
+MS_API int ms_status(const ms_game *game);
+MS_API int ms_width(const ms_game *game);
+MS_API int ms_height(const ms_game *game);
+MS_API int ms_mines(const ms_game *game);
+MS_API int ms_revealed(const ms_game *game); /* Safe cells revealed */
+MS_API int ms_flags(const ms_game *game);
+
+/*
+ * Writes one byte per cell, row by row, into buffer. Returns the number of
+ * bytes the board needs, width * height. If size is smaller than that,
+ * nothing is written, so a first call with size 0 asks for the size.
+ * Returns 0 for a NULL game.
+ */
+MS_API size_t ms_read_state(const ms_game *game, uint8_t *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
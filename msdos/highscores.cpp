@@ -2,6 +2,8 @@
 #include <fstream>
 #include <algorithm>
 #include <cstdlib>
+#include <cstdio>
+#include <climits>
 
 #ifdef _WIN32
     #include <direct.h>
@@ -14,6 +16,17 @@
     #define PATH_SEP "/"
 #endif
 
+// Format 1 files (no "#format" line) stored whole seconds; format 2 stores
+// milliseconds. Older builds skip the format line because it has no '|'.
+static const char SCORE_FORMAT_LINE[] = "#format 2";
+
+std::string formatScoreTime(int timeMs) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d.%03d", timeMs / 60000, timeMs / 1000 % 60,
+             timeMs % 1000);
+    return std::string(buffer);
+}
+
 Highscores::Highscores() {
     #ifdef MSDOS
         const char* home = ".";
@@ -39,7 +52,7 @@ void Highscores::addScore(const Score& score) {
     auto& difficultyScores = scoresByDifficulty[score.difficulty];
     std::sort(difficultyScores.begin(), difficultyScores.end(),
         [](const Score& a, const Score& b) {
-            return a.time < b.time;
+            return a.timeMs < b.timeMs;
         });
     
     // Keep only top MAX_SCORES_PER_DIFFICULTY scores for this difficulty
@@ -68,7 +81,7 @@ std::vector<Score> Highscores::getScoresByDifficulty(const std::string& difficul
     return std::vector<Score>();
 }
 
-bool Highscores::isHighScore(int time, const std::string& difficulty) const {
+bool Highscores::isHighScore(int timeMs, const std::string& difficulty) const {
     auto it = scoresByDifficulty.find(difficulty);
     if (it == scoresByDifficulty.end()) {
         return true;  // First score for this difficulty
@@ -79,7 +92,7 @@ bool Highscores::isHighScore(int time, const std::string& difficulty) const {
         return true;  // Less than max scores for this difficulty
     }
     
-    return time < difficultyScores.back().time;  // Compare with worst time in top 10
+    return timeMs < difficultyScores.back().timeMs;  // Compare with worst time in top 10
 }
 
 void Highscores::loadScores() {
@@ -90,13 +103,23 @@ void Highscores::loadScores() {
     scoresByDifficulty.clear();
     
     std::string line;
+    bool legacySeconds = true;
+    bool first = true;
     while (std::getline(file, line)) {
+        if (first && line.compare(0, sizeof(SCORE_FORMAT_LINE) - 1, SCORE_FORMAT_LINE) == 0) {
+            legacySeconds = false;
+        }
+        first = false;
+
         size_t pos1 = line.find('|');
         size_t pos2 = line.find('|', pos1 + 1);
         if (pos1 != std::string::npos && pos2 != std::string::npos) {
             Score score;
             score.name = line.substr(0, pos1);
-            score.time = std::stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
+            score.timeMs = std::stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
+            if (legacySeconds) {
+                score.timeMs = score.timeMs <= INT_MAX / 1000 ? score.timeMs * 1000 : INT_MAX;
+            }
             score.difficulty = line.substr(pos2 + 1);
             scores.push_back(score);
             scoresByDifficulty[score.difficulty].push_back(score);
@@ -108,7 +131,7 @@ void Highscores::loadScores() {
         auto& difficultyScores = pair.second;
         std::sort(difficultyScores.begin(), difficultyScores.end(),
             [](const Score& a, const Score& b) {
-                return a.time < b.time;
+                return a.timeMs < b.timeMs;
             });
         if (difficultyScores.size() > MAX_SCORES_PER_DIFFICULTY) {
             difficultyScores.resize(MAX_SCORES_PER_DIFFICULTY);
@@ -120,13 +143,19 @@ void Highscores::loadScores() {
     for (const auto& pair : scoresByDifficulty) {
         scores.insert(scores.end(), pair.second.begin(), pair.second.end());
     }
+
+    // Rewrite a seconds-based file in milliseconds straight away
+    if (legacySeconds && !scores.empty()) {
+        saveScores();
+    }
 }
 
 void Highscores::saveScores() {
     std::ofstream file(scorePath);
     if (!file) return;
     
+    file << SCORE_FORMAT_LINE << '\n';
     for (const auto& score : scores) {
-        file << score.name << '|' << score.time << '|' << score.difficulty << '\n';
+        file << score.name << '|' << score.timeMs << '|' << score.difficulty << '\n';
     }
 }
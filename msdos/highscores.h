@@ -5,17 +5,20 @@
 
 struct Score {
     std::string name;
-    int time;
+    int timeMs;  // Milliseconds from the first reveal to the last
     std::string difficulty;
 };
 
+/* "MM:SS.mmm", as shown in the high score lists */
+std::string formatScoreTime(int timeMs);
+
 class Highscores {
 public:
     Highscores();
     void addScore(const Score& score);
     const std::vector<Score>& getScores() const;
     std::vector<Score> getScoresByDifficulty(const std::string& difficulty) const;
-    bool isHighScore(int time, const std::string& difficulty) const;
+    bool isHighScore(int timeMs, const std::string& difficulty) const;
 
 private:
     void loadScores();
@@ -39,18 +39,29 @@ const DifficultySettings DIFFICULTY_SETTINGS[] = {
     {16, 30, 99}  // HARD
 };
 
-// Timer class for MS-DOS
+// Timer class for MS-DOS. uclock() reads the PIT directly (about 840ns
+// resolution); clock() only ticks every 55ms.
+#ifdef __DJGPP__
+typedef uclock_t TimerTicks;
+#define TIMER_NOW() uclock()
+#define TIMER_TICKS_PER_SEC UCLOCKS_PER_SEC
+#else
+typedef clock_t TimerTicks;
+#define TIMER_NOW() clock()
+#define TIMER_TICKS_PER_SEC CLOCKS_PER_SEC
+#endif
+
 class Timer {
 private:
-  clock_t startTime;
+  TimerTicks startTime;
   bool running;
-  int elapsedSeconds;
+  int elapsedMillis;
 
 public:
-  Timer() : running(false), elapsedSeconds(0) {}
+  Timer() : running(false), elapsedMillis(0) {}
 
   void start() {
-    startTime = clock();
+    startTime = TIMER_NOW();
     running = true;
   }
 
@@ -61,20 +72,22 @@ public:
     }
   }
 
-  int getElapsedSeconds() const { return elapsedSeconds; }
+  int getElapsedSeconds() const { return elapsedMillis / 1000; }
+  int getElapsedMillis() const { return elapsedMillis; }
 
   void update() {
     if (running) {
-      clock_t now = clock();
-      // Convert clock ticks to seconds
-      elapsedSeconds = (now - startTime) / CLOCKS_PER_SEC;
+      TimerTicks now = TIMER_NOW();
+      // Convert clock ticks to milliseconds
+      elapsedMillis = static_cast<int>(static_cast<long long>(now - startTime) *
+                                       1000 / TIMER_TICKS_PER_SEC);
     }
   }
 
   std::string getTimeString() const {
-    int minutes = elapsedSeconds / 60;
-    int seconds = elapsedSeconds % 60;
-    char buffer[10];
+    int minutes = elapsedMillis / 60000;
+    int seconds = elapsedMillis / 1000 % 60;
+    char buffer[16];
     snprintf(buffer, sizeof(buffer), "%02d:%02d", minutes, seconds);
     return std::string(buffer);
   }
@@ -108,7 +121,7 @@ private:
   std::string customMines;
   int customStep = 0; // 0=width, 1=height, 2=mines
 
-  bool isHighScore(int time) {
+  bool isHighScore(int timeMs) {
     const auto &scores = highscores.getScores();
     std::string currentDifficulty;
 
@@ -133,7 +146,7 @@ private:
     for (const auto &score : scores) {
       if (score.difficulty == currentDifficulty) {
         difficultyScores++;
-        if (score.time > time) {
+        if (score.timeMs > timeMs) {
           worseThanCurrent = true;
         }
       }
@@ -216,14 +229,8 @@ private:
     mvprintw(row++, 2, "----------------------------------------");
 
     for (const auto &score : scores) {
-      // Convert seconds to minutes:seconds format
-      int minutes = score.time / 60;
-      int seconds = score.time % 60;
-      char timeStr[10];
-      snprintf(timeStr, sizeof(timeStr), "%02d:%02d", minutes, seconds);
-
-      mvprintw(row++, 2, "%-20s %-10s %-10s", score.name.c_str(), timeStr,
-               score.difficulty.c_str());
+      mvprintw(row++, 2, "%-20s %-10s %-10s", score.name.c_str(),
+               formatScoreTime(score.timeMs).c_str(), score.difficulty.c_str());
     }
 
     mvprintw(row + 2, 2, "Press any key to return");
@@ -236,7 +243,8 @@ private:
     // Use absolute positions instead of calculated ones for testing
     mvprintw(2, 2, "MINESWEEPER");
     mvprintw(4, 2, "NEW HIGH SCORE!");
-    mvprintw(6, 2, "Your time: %s", timer.getTimeString().c_str());
+    mvprintw(6, 2, "Your time: %s",
+             formatScoreTime(timer.getElapsedMillis()).c_str());
     mvprintw(8, 2, "Enter your name: %s", playerName.c_str());
     mvprintw(10, 2, "Press Enter when done (ESC to cancel)");
 
@@ -481,7 +489,7 @@ void initializeMinefield(int firstY, int firstX, int seed = -1) {
       if (!playerName.empty()) { // Only accept if name isn't empty
         Score score;
         score.name = playerName;
-        score.time = timer.getElapsedSeconds();
+        score.timeMs = timer.getElapsedMillis();
 
         switch (difficulty) {
         case Difficulty::EASY:
@@ -550,7 +558,7 @@ void updateTitle() {
             mvprintw(0, title.length() + 5, "Time: %s - Seed: %i - You win",
                      timer.getTimeString().c_str(), currentSeed);
             timer.stop();
-            if (isHighScore(timer.getElapsedSeconds())) {
+            if (isHighScore(timer.getElapsedMillis())) {
                 state = GameState::ENTER_NAME;
                 playerName = "";
             } else {
@@ -783,7 +791,7 @@ void updateTitle() {
             won = checkWin();
             if (won) {
               timer.stop();
-              if (isHighScore(timer.getElapsedSeconds())) {
+              if (isHighScore(timer.getElapsedMillis())) {
                 state = GameState::ENTER_NAME;
                 playerName = "";
               } else {
@@ -820,7 +828,7 @@ void updateTitle() {
       break;
     case 'k':
     case 'K':
-      if (isHighScore(timer.getElapsedSeconds())) {
+      if (isHighScore(timer.getElapsedMillis())) {
         state = GameState::ENTER_NAME;
         playerName = "";
       } else {
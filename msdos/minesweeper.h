@@ -4,6 +4,9 @@
 #include <vector>
 #include <map>
 #include <ctime>
+#ifndef __DJGPP__
+#include <chrono>
+#endif
 #include "highscores.h"
 
 /* Game state enum */
@@ -31,30 +34,47 @@ struct DifficultySettings {
     int mines;
 };
 
+/* Monotonic clock in microseconds. DJGPP's uclock() reads the PIT directly
+   (about 840ns resolution); time() only counts whole seconds. */
+inline long long timerNowMicros() {
+#ifdef __DJGPP__
+    return static_cast<long long>(uclock()) * 1000000 / UCLOCKS_PER_SEC;
+#else
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
 /* Timer class */
 class Timer {
 public:
-    Timer() : startTime(0), stopTime(0), isRunning(false) {}
+    Timer() : startTime(0), stopTime(0), isRunning(false), hasStarted(false) {}
     
     void start() {
-        startTime = time(nullptr);
+        startTime = timerNowMicros();
         isRunning = true;
+        hasStarted = true;
         stopTime = 0;
     }
     
     void stop() {
-        stopTime = time(nullptr);
+        if (!isRunning) return;
+        stopTime = timerNowMicros();
         isRunning = false;
     }
     
     void update() {
-        /* Timer updates itself via system time */
+        /* Timer updates itself via the system clock */
+    }
+    
+    int getElapsedMillis() const {
+        if (!hasStarted) return 0;  /* uclock() itself starts from 0 */
+        long long current = isRunning ? timerNowMicros() : stopTime;
+        return static_cast<int>((current - startTime) / 1000);
     }
     
     int getElapsedSeconds() const {
-        if (startTime == 0) return 0;
-        time_t current = stopTime > 0 ? stopTime : time(nullptr);
-        return static_cast<int>(difftime(current, startTime));
+        return getElapsedMillis() / 1000;
     }
     
     std::string getTimeString() const {
@@ -67,9 +87,10 @@ public:
     }
 
 private:
-    time_t startTime;
-    time_t stopTime;
+    long long startTime;
+    long long stopTime;
     bool isRunning;
+    bool hasStarted;
 };
 
 /* Main Minesweeper Game Class */
@@ -119,7 +140,7 @@ public:
     void handleCustomDifficulty(int ch);
     
     /* High scores */
-    bool isHighScore(int time) const;
+    bool isHighScore(int timeMs) const;
     void saveHighscore();
     
     /* Drawing (handled by GUI) */
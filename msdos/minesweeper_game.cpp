@@ -221,7 +221,7 @@ void Minesweeper::toggleFlag(int x, int y) {
 }
 
 /* Check if score qualifies as high score */
-bool Minesweeper::isHighScore(int time) const {
+bool Minesweeper::isHighScore(int timeMs) const {
     std::string currentDifficulty;
 
     switch (difficulty) {
@@ -246,7 +246,7 @@ bool Minesweeper::isHighScore(int time) const {
     for (const auto &score : scores) {
         if (score.difficulty == currentDifficulty) {
             difficultyScores++;
-            if (score.time > time) {
+            if (score.timeMs > timeMs) {
                 worseThanCurrent = true;
             }
         }
@@ -261,7 +261,7 @@ bool Minesweeper::isHighScore(int time) const {
 void Minesweeper::saveHighscore() {
     Score score;
     score.name = playerName;
-    score.time = timer.getElapsedSeconds();
+    score.timeMs = timer.getElapsedMillis();
 
     switch (difficulty) {
     case Difficulty::EASY:
@@ -374,7 +374,7 @@ bool Minesweeper::handleInput(int ch) {
             break;
         case 'k':
         case 'K':
-            if (isHighScore(timer.getElapsedSeconds())) {
+            if (isHighScore(timer.getElapsedMillis())) {
                 state = GameState::ENTER_NAME;
                 playerName = "";
             } else {
@@ -349,7 +349,8 @@ void draw_minesweeper_screen() {
             for (const auto& score : scores) {
                 if (rank > 5) break;  /* Show top 5 per difficulty */
                 char score_str[64];
-                sprintf(score_str, "%d. %s - %d sec", rank, score.name.c_str(), score.time);
+                snprintf(score_str, sizeof(score_str), "%d. %s - %s", rank, score.name.c_str(),
+                         formatScoreTime(score.timeMs).c_str());
                 textout_ex(active_buffer, font, score_str, 170, y_pos + (rank * 20), COLOR_BLACK, COLOR_WHITE);
                 rank++;
             }
@@ -398,7 +398,7 @@ void process_input(Minesweeper *game, bool &running) {
                 mark_screen_dirty();
             } else {
                 /* Any other key: go back to playing (old behavior) */
-                if (!game->gameOver && game->won && game->isHighScore(game->timer.getElapsedSeconds())) {
+                if (!game->gameOver && game->won && game->isHighScore(game->timer.getElapsedMillis())) {
                     game->state = GameState::ENTER_NAME;
                     minesweeper_gui.entering_name = true;
                     minesweeper_gui.player_name_length = 0;
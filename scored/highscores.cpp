@@ -0,0 +1 @@
+../src/highscores.cpp
\ No newline at end of file
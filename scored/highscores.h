@@ -0,0 +1 @@
+../src/highscores.h
\ No newline at end of file
@@ -0,0 +1,296 @@
+// minesweeper-scored: a leaderboard daemon for the Linux front-ends.
+//
+// By default the socket lives in $XDG_RUNTIME_DIR, so each user runs their
+// own daemon and only they can reach it. For one leaderboard across a
+// machine, start a single daemon with --socket pointing into a directory
+// the players' group can enter, under a umask that lets the group connect,
+// and set MINESWEEPER_SCORED to that path for every player.
+//
+// Front-ends connect over a Unix domain socket and speak the protocol in
+// scoreprotocol.h. The daemon owns an ordinary Highscores store: queries
+// are answered from its in-memory tables, and submissions go through the
+// store's background writer, which commits each burst with one append and
+// one fsync. A single thread multiplexes every client with poll().
+#include "highscores.h"
+#include "scoreprotocol.h"
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+    volatile sig_atomic_t stopRequested = 0;
+
+    void requestStop(int) {
+        stopRequested = 1;
+    }
+
+    struct Client {
+        int fd;
+        std::string input;   // Bytes received, not yet a complete frame
+        std::string output;  // Replies not yet accepted by the socket
+    };
+
+    class Server {
+    public:
+        explicit Server(Highscores& scores) : scores(scores) {}
+
+        ~Server() {
+            for (const auto& client : clients) {
+                close(client.fd);
+            }
+            if (listener >= 0) {
+                close(listener);
+                unlink(socketPath.c_str());
+            }
+        }
+
+        bool listen(const std::string& path);
+        void run();
+
+    private:
+        void acceptClients();
+        bool readFrom(Client& client);
+        bool writeTo(Client& client);
+        void handle(Client& client, std::string_view request);
+        const std::string& tableReply();
+
+        Highscores& scores;
+        std::string socketPath;
+        int listener = -1;
+        std::vector<Client> clients;
+        std::vector<pollfd> polled;
+
+        // FETCH replies only change with the tables, so one encoding is
+        // shared by every client asking for the same generation
+        uint64_t cachedGeneration = 0;
+        std::string cachedTable;
+    };
+
+    bool setNonBlocking(int fd) {
+        int flags = fcntl(fd, F_GETFL, 0);
+        return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) == 0;
+    }
+
+    bool Server::listen(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) {
+            fprintf(stderr, "Socket path too long: %s\n", path.c_str());
+            return false;
+        }
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        // A socket file nobody answers on is left over from a crash
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (probe >= 0) {
+            bool live = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            close(probe);
+            if (live) {
+                fprintf(stderr, "Another daemon is already listening on %s\n", path.c_str());
+                return false;
+            }
+        }
+        unlink(path.c_str());
+
+        listener = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listener < 0 ||
+            bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            ::listen(listener, SOMAXCONN) != 0 || !setNonBlocking(listener)) {
+            perror("minesweeper-scored");
+            return false;
+        }
+        socketPath = path;
+        return true;
+    }
+
+    void Server::run() {
+        while (!stopRequested) {
+            polled.clear();
+            polled.push_back(pollfd{listener, POLLIN, 0});
+            for (const auto& client : clients) {
+                short events = client.output.empty() ? POLLIN : POLLIN | POLLOUT;
+                polled.push_back(pollfd{client.fd, events, 0});
+            }
+
+            if (poll(polled.data(), polled.size(), -1) < 0) {
+                if (errno == EINTR) continue;
+                perror("poll");
+                return;
+            }
+
+            // Walk backwards so closed clients can be swapped out in place
+            for (size_t i = clients.size(); i-- > 0;) {
+                short events = polled[i + 1].revents;
+                Client& client = clients[i];
+                bool open = true;
+                if (events & (POLLIN | POLLHUP | POLLERR)) {
+                    open = readFrom(client);
+                }
+                if (open && !client.output.empty()) {
+                    open = writeTo(client);
+                }
+                if (!open) {
+                    close(client.fd);
+                    clients[i] = std::move(clients.back());
+                    clients.pop_back();
+                }
+            }
+            if (polled[0].revents & POLLIN) {
+                acceptClients();
+            }
+        }
+    }
+
+    void Server::acceptClients() {
+        for (;;) {
+            int fd = accept(listener, nullptr, nullptr);
+            if (fd < 0) return;
+            if (!setNonBlocking(fd)) {
+                close(fd);
+                continue;
+            }
+            clients.push_back(Client{fd, std::string(), std::string()});
+        }
+    }
+
+    // Reads what is available and answers every complete frame. Returns
+    // false once the client has gone or broken the protocol.
+    bool Server::readFrom(Client& client) {
+        char buffer[16384];
+        for (;;) {
+            ssize_t n = recv(client.fd, buffer, sizeof(buffer), 0);
+            if (n > 0) {
+                client.input.append(buffer, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            return false;
+        }
+
+        size_t consumed = 0;
+        while (client.input.size() - consumed >= 4) {
+            uint32_t length;
+            ScoreProtocol::Reader(std::string_view(client.input).substr(consumed, 4)).u32(length);
+            if (length == 0 || length > ScoreProtocol::MAX_FRAME) return false;
+            if (client.input.size() - consumed - 4 < length) break;
+            handle(client, std::string_view(client.input).substr(consumed + 4, length));
+            consumed += 4 + length;
+        }
+        client.input.erase(0, consumed);
+        return true;
+    }
+
+    bool Server::writeTo(Client& client) {
+        while (!client.output.empty()) {
+            ssize_t n = send(client.fd, client.output.data(), client.output.size(), MSG_NOSIGNAL);
+            if (n > 0) {
+                client.output.erase(0, n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        }
+        return true;
+    }
+
+    void Server::handle(Client& client, std::string_view request) {
+        ScoreProtocol::Reader reader(request);
+        uint8_t opcode = 0;
+        reader.u8(opcode);
+
+        std::string reply;
+        if (opcode == ScoreProtocol::SUBMIT) {
+            std::string_view name, difficulty;
+            uint32_t timeMs;
+            if (reader.string(name) && reader.u32(timeMs) && reader.string(difficulty) &&
+                reader.done() && timeMs <= INT32_MAX) {
+                scores.addScore(Score{std::string(name), static_cast<int>(timeMs),
+                                      std::string(difficulty)});
+                ScoreProtocol::putU8(reply, ScoreProtocol::OK);
+            } else {
+                ScoreProtocol::putU8(reply, ScoreProtocol::BAD_REQUEST);
+            }
+        } else if (opcode == ScoreProtocol::FETCH) {
+            uint64_t known;
+            if (!reader.u64(known) || !reader.done()) {
+                ScoreProtocol::putU8(reply, ScoreProtocol::BAD_REQUEST);
+            } else if (known == scores.changes()) {
+                ScoreProtocol::putU8(reply, ScoreProtocol::UNCHANGED);
+            } else {
+                client.output += tableReply();
+                return;
+            }
+        } else {
+            ScoreProtocol::putU8(reply, ScoreProtocol::BAD_REQUEST);
+        }
+        client.output += ScoreProtocol::frame(reply);
+    }
+
+    const std::string& Server::tableReply() {
+        uint64_t generation = scores.changes();
+        if (generation == cachedGeneration && !cachedTable.empty()) {
+            return cachedTable;
+        }
+
+        std::string payload;
+        ScoreProtocol::putU8(payload, ScoreProtocol::OK);
+        ScoreProtocol::putU64(payload, generation);
+        Highscores::ScoreView view = scores.getScores();
+        ScoreProtocol::putU32(payload, static_cast<uint32_t>(view.size()));
+        for (const auto& score : view) {
+            ScoreProtocol::putString(payload, score.name);
+            ScoreProtocol::putU32(payload, static_cast<uint32_t>(score.timeMs));
+            ScoreProtocol::putString(payload, score.difficulty);
+        }
+        cachedTable = ScoreProtocol::frame(payload);
+        cachedGeneration = generation;
+        return cachedTable;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const char* socketEnv = getenv(ScoreProtocol::SOCKET_ENV);
+    std::string socketPath = socketEnv && *socketEnv ? socketEnv : ScoreProtocol::defaultSocket();
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--socket") == 0 && i + 1 < argc) {
+            socketPath = argv[++i];
+        } else {
+            fprintf(stderr, "Usage: %s [--socket PATH]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (socketPath.empty()) {
+        fprintf(stderr, "XDG_RUNTIME_DIR is not set; pass --socket PATH\n");
+        return 1;
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = requestStop;  // No SA_RESTART, so poll() wakes up
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    Highscores scores;
+    scores.setServer("");  // This is the server
+    scores.startBackgroundWriter();
+    scores.getScores();
+
+    Server server(scores);
+    if (!server.listen(socketPath)) {
+        return 1;
+    }
+    printf("minesweeper-scored: listening on %s, scores in %s\n", socketPath.c_str(),
+           scores.getDirectory().c_str());
+    fflush(stdout);
+    server.run();
+    return 0;  // The writer flushes anything still queued on the way out
+}
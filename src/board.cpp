@@ -0,0 +1,159 @@
+#include "board.h"
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include <utility>
+
+Board::Board(int width, int height, int mines, int seed)
+    : rows(std::max(1, height)), cols(std::max(1, width)), mineSeed(seed) {
+    mineCount = std::max(0, std::min(mines, rows * cols - 9));
+    reset();
+}
+
+void Board::reset() {
+    cells.assign(static_cast<size_t>(rows) * cols, 0);
+    state = Status::PLAYING;
+    placed = false;
+    safeRevealed = 0;
+    flagCount = 0;
+}
+
+void Board::setSeed(int seed) {
+    if (!placed) {
+        mineSeed = seed;
+    }
+}
+
+// The same draws the terminal version has always made, so seeds recorded
+// before the engine was shared still give the same boards
+void Board::placeMines(int safeRow, int safeCol) {
+    std::mt19937 gen(mineSeed);
+    std::uniform_int_distribution<> disH(0, rows - 1);
+    std::uniform_int_distribution<> disW(0, cols - 1);
+
+    int placedMines = 0;
+    while (placedMines < mineCount) {
+        int y = disH(gen);
+        int x = disW(gen);
+        if (!(cell(y, x) & MINE) && (abs(y - safeRow) > 1 || abs(x - safeCol) > 1)) {
+            cell(y, x) |= MINE;
+            placedMines++;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    if (contains(y + dy, x + dx)) {
+                        cell(y + dy, x + dx) += 1 << COUNT_SHIFT;
+                    }
+                }
+            }
+        }
+    }
+    placed = true;
+}
+
+bool Board::reveal(int row, int col) {
+    if (state != Status::PLAYING || !contains(row, col)) return false;
+    if (!placed) {
+        placeMines(row, col);
+    }
+    if (cell(row, col) & (REVEALED | FLAGGED)) return false;
+    if (cell(row, col) & MINE) {
+        lose();
+    } else {
+        flood(row, col);
+    }
+    return true;
+}
+
+bool Board::chord(int row, int col) {
+    if (state != Status::PLAYING || !contains(row, col) || !isRevealed(row, col) ||
+        adjacentMines(row, col) != adjacentFlags(row, col)) {
+        return false;
+    }
+
+    bool opened = false;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            int y = row + dy;
+            int x = col + dx;
+            if (!contains(y, x) || (cell(y, x) & (REVEALED | FLAGGED))) continue;
+            opened = true;
+            if (cell(y, x) & MINE) {
+                lose();
+                return true;
+            }
+            flood(y, x);
+        }
+    }
+    return opened;
+}
+
+bool Board::toggleFlag(int row, int col) {
+    if (state != Status::PLAYING || !contains(row, col) || isRevealed(row, col)) {
+        return false;
+    }
+    cell(row, col) ^= FLAGGED;
+    flagCount += isFlagged(row, col) ? 1 : -1;
+    touched(row * cols + col);
+    return true;
+}
+
+int Board::adjacentFlags(int row, int col) const {
+    int count = 0;
+    for (int dy = -1; dy <= 1; dy++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            if (contains(row + dy, col + dx) && isFlagged(row + dy, col + dx)) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+std::vector<std::vector<bool>> Board::minefield() const {
+    std::vector<std::vector<bool>> field(rows, std::vector<bool>(cols, false));
+    for (int row = 0; row < rows; row++) {
+        for (int col = 0; col < cols; col++) {
+            field[row][col] = isMine(row, col);
+        }
+    }
+    return field;
+}
+
+// Opens a safe cell and, through every blank one reached, its neighbours.
+// Uses an explicit stack, since an opening can cover most of a large board.
+void Board::flood(int row, int col) {
+    std::vector<std::pair<int, int>> pending;
+    cell(row, col) |= REVEALED;
+    pending.emplace_back(row, col);
+    while (!pending.empty()) {
+        int y = pending.back().first;
+        int x = pending.back().second;
+        pending.pop_back();
+        safeRevealed++;
+        touched(y * cols + x);
+        if (adjacentMines(y, x) != 0) continue;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                int ny = y + dy;
+                int nx = x + dx;
+                if (contains(ny, nx) && !(cell(ny, nx) & (REVEALED | FLAGGED))) {
+                    cell(ny, nx) |= REVEALED;
+                    pending.emplace_back(ny, nx);
+                }
+            }
+        }
+    }
+    if (safeRevealed == rows * cols - mineCount) {
+        state = Status::WON;
+    }
+}
+
+void Board::lose() {
+    state = Status::LOST;
+    for (size_t i = 0; i < cells.size(); i++) {
+        if (cells[i] & MINE) {
+            cells[i] |= REVEALED;
+            touched(static_cast<int>(i));
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// The rules of one game with no user interface attached, so the curses
+// screen and headless drivers such as --batch play exactly the same game.
+// Mines are placed from the seed on the first reveal, never in the 3x3
+// around it, so a seed and a first click always give the same board. Every
+// cell is one byte holding its state and adjacent mine count.
+class Board {
+public:
+    enum class Status : uint8_t {
+        PLAYING,
+        WON,
+        LOST
+    };
+
+    Board() = default;
+    // Mines are clamped so the first reveal always has its 3x3 free
+    Board(int width, int height, int mines, int seed);
+
+    // Same size and seed, nothing placed or revealed
+    void reset();
+    // Only before the first reveal; afterwards the board is fixed
+    void setSeed(int seed);
+
+    // Moves are ignored once the game is over or when they are off the
+    // board. Each returns whether it changed anything.
+    bool reveal(int row, int col);
+    // Reveals the unflagged neighbours of a revealed number whose flags
+    // match it
+    bool chord(int row, int col);
+    bool toggleFlag(int row, int col);
+
+    // While a log is set, every cell whose state changes is appended to it
+    // as row * width + col, at most once per move but possibly again by a
+    // later one. The caller owns the log, so a board that is not being
+    // watched costs nothing, and many boards can share one.
+    void trackChanges(std::vector<int>* log) { changeLog = log; }
+
+    int width() const { return cols; }
+    int height() const { return rows; }
+    int mines() const { return mineCount; }
+    int seed() const { return mineSeed; }
+    Status status() const { return state; }
+    bool minesPlaced() const { return placed; }
+    int revealedSafe() const { return safeRevealed; }
+    int flags() const { return flagCount; }
+
+    bool contains(int row, int col) const {
+        return row >= 0 && row < rows && col >= 0 && col < cols;
+    }
+    bool isMine(int row, int col) const { return cell(row, col) & MINE; }
+    bool isRevealed(int row, int col) const { return cell(row, col) & REVEALED; }
+    bool isFlagged(int row, int col) const { return cell(row, col) & FLAGGED; }
+    int adjacentMines(int row, int col) const { return cell(row, col) >> COUNT_SHIFT; }
+    int adjacentFlags(int row, int col) const;
+
+    // Mine layout in the form count3BV() takes
+    std::vector<std::vector<bool>> minefield() const;
+
+private:
+    static const uint8_t MINE = 1;
+    static const uint8_t REVEALED = 2;
+    static const uint8_t FLAGGED = 4;
+    static const int COUNT_SHIFT = 4;
+
+    uint8_t cell(int row, int col) const {
+        return cells[static_cast<size_t>(row) * cols + col];
+    }
+    uint8_t& cell(int row, int col) {
+        return cells[static_cast<size_t>(row) * cols + col];
+    }
+
+    void placeMines(int safeRow, int safeCol);
+    void flood(int row, int col);
+    void lose();
+    void touched(int index) {
+        if (changeLog) changeLog->push_back(index);
+    }
+
+    int rows = 0;
+    int cols = 0;
+    int mineCount = 0;
+    int mineSeed = 0;
+    Status state = Status::PLAYING;
+    bool placed = false;
+    int safeRevealed = 0;
+    int flagCount = 0;
+    std::vector<uint8_t> cells;
+    std::vector<int>* changeLog = nullptr;
+};
@@ -1,132 +1,1432 @@
 #include "highscores.h"
-#include <fstream>
 #include <algorithm>
 #include <cstdlib>
+#include <cstdio>
+#include <iterator>
+#include <charconv>
+#include <cstring>
+#include <climits>
+#include <cerrno>
+#include <utility>
 
 #ifdef _WIN32
     #include <direct.h>
+    #include <io.h>
+    #include <fcntl.h>
+    #include <sys/stat.h>
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
     #define MKDIR(dir) _mkdir(dir)
     #define PATH_SEP "\\"
 #else
     #include <sys/stat.h>
     #include <sys/types.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #ifndef MSDOS
+        #include <sys/file.h>
+        #include <sys/mman.h>
+    #endif
+    #ifndef O_BINARY
+        #define O_BINARY 0
+    #endif
     #define MKDIR(dir) mkdir(dir, 0700)
     #define PATH_SEP "/"
 #endif
 
-Highscores::Highscores() {
-    #ifdef _WIN32
-        const char* home = getenv("APPDATA");
+// Neither DJGPP nor C++/CLI (/clr) builds provide <future>
+#if !defined(MSDOS) && !defined(_M_CEE)
+    #define HIGHSCORES_THREADS
+    #include <condition_variable>
+    #include <deque>
+    #include <future>
+    #include <mutex>
+    #include <thread>
+#endif
+
+// The leaderboard daemon listens on a Unix domain socket
+#if !defined(_WIN32) && !defined(MSDOS)
+    #define HIGHSCORES_SERVER
+    #include "scoreprotocol.h"
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <sys/un.h>
+#endif
+
+namespace {
+    // Snapshot header lines; older builds skip them because they have no '|'
+    const char SNAPSHOT_FORMAT_TAG[] = "#format ";
+    const char SNAPSHOT_SEQUENCE_TAG[] = "#journal ";
+
+    struct PresetBoard {
+        const char* name;
+        int width;
+        int height;
+        int mines;
+    };
+
+    const PresetBoard PRESET_BOARDS[] = {
+        {"Easy", 9, 9, 10},
+        {"Medium", 16, 16, 40},
+        {"Hard", 30, 16, 99}
+    };
+
+    const char CUSTOM_BOARD_PREFIX[] = "Custom ";
+
+    // Format 1 (no tag) stored whole seconds; format 2 stores milliseconds.
+    // A journal always uses the units of the snapshot it extends.
+    const int SCORE_FORMAT_VERSION = 2;
+
+    bool writeAll(int fd, const std::string& data) {
+        const char* p = data.data();
+        size_t left = data.size();
+        while (left > 0) {
+#ifdef _WIN32
+            int n = _write(fd, p, static_cast<unsigned int>(left));
+#else
+            ssize_t n = write(fd, p, left);
+#endif
+            if (n <= 0) return false;
+            p += n;
+            left -= n;
+        }
+        return true;
+    }
+
+    bool syncAndClose(int fd) {
+#ifdef _WIN32
+        bool ok = _commit(fd) == 0;
+        return _close(fd) == 0 && ok;
+#else
+        bool ok = fsync(fd) == 0;
+        return close(fd) == 0 && ok;
+#endif
+    }
+
+    // Appends one record with a single write so a crash can at worst leave a
+    // torn final line, which loadJournal() ignores.
+    bool appendDurably(const std::string& path, const std::string& data) {
+#ifdef _WIN32
+        int fd = _open(path.c_str(), _O_WRONLY | _O_APPEND | _O_CREAT | _O_BINARY,
+                       _S_IREAD | _S_IWRITE);
+#else
+        int fd = open(path.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0600);
+#endif
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, data);
+        return syncAndClose(fd) && ok;
+    }
+
+    // Writes a complete temp file, flushes it to disk and renames it over the
+    // target, so readers only ever see the old or the new file in full.
+    bool replaceAtomically(const std::string& path, const std::string& data) {
+        std::string tempPath = path + ".tmp";
+#ifdef _WIN32
+        int fd = _open(tempPath.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                       _S_IREAD | _S_IWRITE);
+#else
+        int fd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+#endif
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, data);
+        if (!syncAndClose(fd) || !ok) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+#ifdef _WIN32
+        return MoveFileExA(tempPath.c_str(), path.c_str(),
+                           MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    #ifdef MSDOS
+        // DOS rename() refuses to replace an existing file
+        std::remove(path.c_str());
+    #endif
+        return std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+    }
+
+    // Read-only view of a whole file. The file is memory-mapped, so parsing
+    // works straight from the page cache without copying it into a buffer.
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string& path) {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+                               nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE) return;
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) return;
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (!mapping) return;
+            void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (!view) return;
+            data = static_cast<const char*>(view);
+            size = static_cast<size_t>(fileSize.QuadPart);
+#elif defined(MSDOS)
+            // No mmap under DJGPP; read the file into one buffer instead
+            int fd = open(path.c_str(), O_RDONLY | O_BINARY);
+            if (fd < 0) return;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                buffer.resize(info.st_size);
+                ssize_t n = read(fd, &buffer[0], buffer.size());
+                buffer.resize(n > 0 ? n : 0);
+                data = buffer.data();
+                size = buffer.size();
+            }
+            close(fd);
+#else
+            int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void* view = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (view != MAP_FAILED) {
+                    madvise(view, info.st_size, MADV_SEQUENTIAL);
+                    data = static_cast<const char*>(view);
+                    size = static_cast<size_t>(info.st_size);
+                }
+            }
+            close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+            if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#elif defined(MSDOS)
+            // buffer releases itself
+#else
+            if (data) munmap(const_cast<char*>(data), size);
+#endif
+        }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        std::string_view contents() const { return std::string_view(data, size); }
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#elif defined(MSDOS)
+        std::string buffer;
+#endif
+    };
+
+    // Splits off the next '\n'-terminated line. A trailing fragment without a
+    // newline is only returned when allowPartial is set.
+    bool nextLine(std::string_view& text, std::string_view& line, bool allowPartial) {
+        if (text.empty()) return false;
+        const char* newline = static_cast<const char*>(std::memchr(text.data(), '\n', text.size()));
+        if (!newline) {
+            if (!allowPartial) return false;
+            line = text;
+            text = std::string_view();
+        } else {
+            size_t length = newline - text.data();
+            line = text.substr(0, length);
+            text.remove_prefix(length + 1);
+        }
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+        return true;
+    }
+
+    template <typename T>
+    bool parseNumber(std::string_view text, T& value) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+        return result.ec == std::errc() && result.ptr == text.data() + text.size();
+    }
+
+    // "name|time|difficulty", parsed in place
+    bool parseScoreFields(std::string_view line, std::string_view& name, int& time,
+                          std::string_view& difficulty) {
+        size_t pos1 = line.find('|');
+        if (pos1 == std::string_view::npos) return false;
+        size_t pos2 = line.find('|', pos1 + 1);
+        if (pos2 == std::string_view::npos) return false;
+        if (!parseNumber(line.substr(pos1 + 1, pos2 - pos1 - 1), time) || time < 0) return false;
+        name = line.substr(0, pos1);
+        difficulty = line.substr(pos2 + 1);
+        return true;
+    }
+
+    // "sequence|name|time|difficulty", as appended to the journal
+    bool parseJournalRecord(std::string_view line, unsigned long& sequence, std::string_view& name,
+                            int& time, std::string_view& difficulty) {
+        size_t sep = line.find('|');
+        if (sep == std::string_view::npos || !parseNumber(line.substr(0, sep), sequence) ||
+            sequence == 0) {
+            return false;
+        }
+        return parseScoreFields(line.substr(sep + 1), name, time, difficulty);
+    }
+
+    // Highest journal sequence in use on disk, from the snapshot's sequence
+    // line and the complete journal records
+    unsigned long lastSequenceOnDisk(const std::string& scorePath, const std::string& journalPath) {
+        const std::string_view sequenceTag(SNAPSHOT_SEQUENCE_TAG);
+        unsigned long last = 0;
+        MappedFile snapshot(scorePath);
+        std::string_view text = snapshot.contents();
+        std::string_view line;
+        for (int i = 0; i < 2 && nextLine(text, line, true); i++) {  // Follows "#format"
+            if (line.substr(0, sequenceTag.size()) == sequenceTag) {
+                parseNumber(line.substr(sequenceTag.size()), last);
+            }
+        }
+
+        MappedFile journal(journalPath);
+        text = journal.contents();
+        while (nextLine(text, line, false)) {
+            unsigned long sequence;
+            std::string_view name, difficulty;
+            int time;
+            if (parseJournalRecord(line, sequence, name, time, difficulty)) {
+                last = std::max(last, sequence);
+            }
+        }
+        return last;
+    }
+
+    // Start of scores.lock, mapped shared by every process using the files.
+    // Only lock holders change it; readers just load the counters.
+    struct StoreHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint64_t generation;    // Bumped after every append and compaction
+        uint64_t compactions;   // Bumped whenever the snapshot is rewritten
+        uint64_t nextSequence;  // Next journal sequence; 0 until a writer has looked
+    };
+
+    static_assert(sizeof(StoreHeader) <= Highscores::STORE_LOCK_OFFSET,
+                  "the lock byte must stay clear of the mapped header");
+
+    const uint32_t STORE_MAGIC = 0x4d535753;
+    const uint32_t STORE_VERSION = 1;
+
+    // The header is read without the lock, so its counters are accessed
+    // atomically. C++/CLI has no <atomic>, hence the intrinsics.
+    uint64_t loadShared(const uint64_t& value) {
+#ifdef _WIN32
+        return static_cast<uint64_t>(InterlockedCompareExchange64(
+            reinterpret_cast<volatile LONG64*>(const_cast<uint64_t*>(&value)), 0, 0));
+#else
+        return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+#endif
+    }
+
+    void storeShared(uint64_t& value, uint64_t newValue) {
+#ifdef _WIN32
+        InterlockedExchange64(reinterpret_cast<volatile LONG64*>(&value),
+                              static_cast<LONG64>(newValue));
+#else
+        __atomic_store_n(&value, newValue, __ATOMIC_RELEASE);
+#endif
+    }
+
+    // Recovers the board behind a leaderboard name: a preset, or "Custom WxH/M"
+    bool parseBoardName(std::string_view name, BoardKey& board) {
+        for (const auto& preset : PRESET_BOARDS) {
+            if (name == preset.name) {
+                board = Highscores::packBoard(preset.width, preset.height, preset.mines);
+                return true;
+            }
+        }
+
+        const std::string_view prefix(CUSTOM_BOARD_PREFIX);
+        if (name.substr(0, prefix.size()) != prefix) return false;
+        name.remove_prefix(prefix.size());
+        size_t x = name.find('x');
+        size_t slash = name.find('/');
+        if (x == std::string_view::npos || slash == std::string_view::npos || slash < x) {
+            return false;
+        }
+        int width, height, mines;
+        if (!parseNumber(name.substr(0, x), width) ||
+            !parseNumber(name.substr(x + 1, slash - x - 1), height) ||
+            !parseNumber(name.substr(slash + 1), mines)) {
+            return false;
+        }
+        board = Highscores::packBoard(width, height, mines);
+        return true;
+    }
+}
+
+std::string formatScoreTime(int timeMs) {
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "%02d:%02d.%03d", timeMs / 60000, timeMs / 1000 % 60,
+             timeMs % 1000);
+    return buffer;
+}
+
+// Leaderboard implementation
+Leaderboard::Leaderboard(size_t capacity) : capacity(capacity) {
+    scores.reserve(capacity + 1);
+}
+
+bool Leaderboard::qualifies(int timeMs) const {
+    return scores.size() < capacity || timeMs < scores.back().timeMs;
+}
+
+bool Leaderboard::insert(const Score& score) {
+    if (!qualifies(score.timeMs)) {
+        return false;
+    }
+    // Equal times keep their original order, so the earlier score ranks higher
+    auto pos = std::upper_bound(scores.begin(), scores.end(), score.timeMs,
+        [](int timeMs, const Score& entry) {
+            return timeMs < entry.timeMs;
+        });
+    scores.insert(pos, score);
+    if (scores.size() > capacity) {
+        scores.pop_back();
+    }
+    return true;
+}
+
+// ScoreView implementation
+Highscores::ScoreView::iterator::iterator(const std::vector<Leaderboard>* boards,
+                                          size_t board, size_t index)
+    : boards(boards), board(board), index(index) {
+    skipEmpty();
+}
+
+const Score& Highscores::ScoreView::iterator::operator*() const {
+    return (*boards)[board].entries()[index];
+}
+
+const Score* Highscores::ScoreView::iterator::operator->() const {
+    return &(*boards)[board].entries()[index];
+}
+
+Highscores::ScoreView::iterator& Highscores::ScoreView::iterator::operator++() {
+    index++;
+    skipEmpty();
+    return *this;
+}
+
+bool Highscores::ScoreView::iterator::operator==(const iterator& other) const {
+    return board == other.board && index == other.index;
+}
+
+bool Highscores::ScoreView::iterator::operator!=(const iterator& other) const {
+    return !(*this == other);
+}
+
+void Highscores::ScoreView::iterator::skipEmpty() {
+    while (board < boards->size() && index >= (*boards)[board].entries().size()) {
+        board++;
+        index = 0;
+    }
+}
+
+Highscores::ScoreView::ScoreView(const std::vector<Leaderboard>* boards) : boards(boards) {}
+
+Highscores::ScoreView::iterator Highscores::ScoreView::begin() const {
+    return iterator(boards, 0, 0);
+}
+
+Highscores::ScoreView::iterator Highscores::ScoreView::end() const {
+    return iterator(boards, boards->size(), 0);
+}
+
+size_t Highscores::ScoreView::size() const {
+    size_t total = 0;
+    for (const auto& board : *boards) {
+        total += board.entries().size();
+    }
+    return total;
+}
+
+bool Highscores::ScoreView::empty() const {
+    return begin() == end();
+}
+
+// Highscores implementation
+const DifficultyKey Highscores::NO_DIFFICULTY;
+const uint32_t Highscores::STORE_LOCK_OFFSET;
+
+struct Highscores::PendingLoad {
+#ifdef HIGHSCORES_THREADS
+    std::future<void> result;
+#endif
+};
+
+// scores.lock: an advisory lock that serialises writers across processes,
+// and the StoreHeader they publish through. Where the file cannot be opened
+// or mapped, and always under DOS, a private header stands in and locking
+// does nothing.
+struct Highscores::Store {
+    std::string dirPath;
+    std::string scorePath;
+    std::string journalPath;
+    StoreHeader localHeader{};
+    StoreHeader* header = &localHeader;
+#ifdef _WIN32
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = nullptr;
+    void* view = nullptr;
+#elif !defined(MSDOS)
+    int fd = -1;
+    void* view = nullptr;
+#endif
+#ifdef HIGHSCORES_THREADS
+    std::mutex threadLock;  // flock() does not exclude threads sharing one fd
+#endif
+
+    Store(const Highscores& owner)
+        : dirPath(owner.dirPath), scorePath(owner.scorePath), journalPath(owner.journalPath) {
+#ifdef _WIN32
+        file = CreateFileA(owner.lockPath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                           FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                           OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return;
+        lock();
+        // Grows the file to the header size if it is shorter
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, sizeof(StoreHeader), nullptr);
+        if (mapping) {
+            view = MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(StoreHeader));
+        }
+#elif !defined(MSDOS)
+        fd = open(owner.lockPath.c_str(), O_RDWR | O_CREAT, 0600);
+        if (fd < 0) return;
+        lock();
+        struct stat info;
+        if (fstat(fd, &info) == 0 &&
+            (info.st_size >= static_cast<off_t>(sizeof(StoreHeader)) ||
+             ftruncate(fd, sizeof(StoreHeader)) == 0)) {
+            view = mmap(nullptr, sizeof(StoreHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (view == MAP_FAILED) view = nullptr;
+        }
+#endif
+#ifndef MSDOS
+        if (view) {
+            header = static_cast<StoreHeader*>(view);
+        }
+        // A new (zero-filled) or foreign file; nobody can be relying on it yet
+        if (header->magic != STORE_MAGIC || header->version != STORE_VERSION) {
+            std::memset(header, 0, sizeof(StoreHeader));
+            header->magic = STORE_MAGIC;
+            header->version = STORE_VERSION;
+        }
+        unlock();
+#endif
+    }
+
+    ~Store() {
+#ifdef _WIN32
+        if (view) UnmapViewOfFile(view);
+        if (mapping) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+#elif !defined(MSDOS)
+        if (view) munmap(view, sizeof(StoreHeader));
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    Store(const Store&) = delete;
+    Store& operator=(const Store&) = delete;
+
+    void lock() {
+#ifdef HIGHSCORES_THREADS
+        threadLock.lock();
+#endif
+#ifdef _WIN32
+        if (file != INVALID_HANDLE_VALUE) {
+            // The lock covers a byte past the header, so it never gets in
+            // the way of the mapped view
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = STORE_LOCK_OFFSET;
+            LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped);
+        }
+#elif !defined(MSDOS)
+        if (fd >= 0) {
+            while (flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+        }
+#endif
+    }
+
+    void unlock() {
+#ifdef _WIN32
+        if (file != INVALID_HANDLE_VALUE) {
+            OVERLAPPED overlapped = {};
+            overlapped.Offset = STORE_LOCK_OFFSET;
+            UnlockFileEx(file, 0, 1, 0, &overlapped);
+        }
+#elif !defined(MSDOS)
+        if (fd >= 0) {
+            flock(fd, LOCK_UN);
+        }
+#endif
+#ifdef HIGHSCORES_THREADS
+        threadLock.unlock();
+#endif
+    }
+
+    void publish(bool compacted) {
+        if (compacted) {
+            storeShared(header->compactions, header->compactions + 1);
+        }
+        storeShared(header->generation, header->generation + 1);
+    }
+
+    // Numbers the records ("name|time|difficulty\n" each) and appends them
+    // with one write and one fsync
+    bool append(const std::vector<std::string>& records) {
+        MKDIR(dirPath.c_str());
+        lock();
+        uint64_t sequence = header->nextSequence;
+        if (sequence == 0 || header == &localHeader) {
+            // Without a shared header other writers' numbers are unknown
+            sequence = lastSequenceOnDisk(scorePath, journalPath) + 1;
+        }
+        std::string data;
+        for (const auto& record : records) {
+            data += std::to_string(sequence++) + '|' + record;
+        }
+        bool ok = appendDurably(journalPath, data);
+        if (ok) {
+            storeShared(header->nextSequence, sequence);
+            publish(false);
+        }
+        unlock();
+        return ok;
+    }
+
+    // Folds the journal into a fresh snapshot. The snapshot is rebuilt from
+    // the files rather than from any one process's tables, and the lock is
+    // held throughout, so nothing another process appended can be lost. It
+    // records the last sequence it contains, so a crash between the rename
+    // and the journal truncation cannot apply the same entries twice.
+    bool compact(bool force) {
+        lock();
+        Highscores disk(dirPath);
+        disk.loadScores();
+        bool ok = true;
+        if (force || disk.journalEntries >= disk.COMPACT_AFTER_ENTRIES) {
+            ok = replaceAtomically(scorePath, disk.snapshotText());
+            if (ok) {
+                replaceAtomically(journalPath, std::string());
+                if (header->nextSequence <= disk.appliedSequence) {
+                    storeShared(header->nextSequence, disk.appliedSequence + 1);
+                }
+                publish(true);
+            }
+        }
+        unlock();
+        return ok;
+    }
+};
+
+// Connection to minesweeper-scored. Calls are blocking with a timeout, so
+// a daemon that hangs is given up on rather than freezing the game. Once a
+// background writer runs, every call is made on its thread, and the results
+// wait here until the owner's thread takes them in.
+struct Highscores::Server {
+#ifdef HIGHSCORES_SERVER
+    int fd = -1;
+
+    std::mutex mutex;           // Guards the fields below
+    bool fetching = false;      // A FETCH is queued or in flight
+    bool lost = false;          // A background call failed; the daemon is gone
+    bool tableReady = false;    // table holds a newer generation than the owner's
+    uint64_t tableGeneration = 0;
+    std::vector<Score> table;
+    std::vector<Score> sending;  // Submitted, not yet acknowledged
+    std::vector<Score> unsent;   // Never acknowledged; to be kept locally
+
+    ~Server() {
+        if (fd >= 0) close(fd);
+    }
+
+    bool connect(const std::string& path) {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        if (path.size() >= sizeof(address.sun_path)) return false;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return false;
+        timeval timeout = {1, 0};
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        return ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+    }
+
+    bool sendAll(const std::string& data) {
+    #ifdef MSG_NOSIGNAL
+        const int flags = MSG_NOSIGNAL;  // A closed daemon is an error, not SIGPIPE
     #else
-        const char* home = getenv("HOME");
+        const int flags = 0;
     #endif
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = send(fd, data.data() + sent, data.size() - sent, flags);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += n;
+        }
+        return true;
+    }
+
+    bool receiveAll(char* data, size_t size) {
+        size_t received = 0;
+        while (received < size) {
+            ssize_t n = recv(fd, data + received, size - received, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            received += n;
+        }
+        return true;
+    }
+
+    // One request, one reply
+    bool call(const std::string& request, std::string& reply) {
+        if (!sendAll(ScoreProtocol::frame(request))) return false;
+        char prefix[4];
+        if (!receiveAll(prefix, sizeof(prefix))) return false;
+        uint32_t length;
+        ScoreProtocol::Reader(std::string_view(prefix, sizeof(prefix))).u32(length);
+        if (length == 0 || length > ScoreProtocol::MAX_FRAME) return false;
+        reply.resize(length);
+        return receiveAll(&reply[0], length);
+    }
+
+    // Asks for the table unless the daemon is still at generation known;
+    // changed says whether table and generation were filled in. Returns
+    // false when the connection failed.
+    bool fetch(uint64_t known, bool& changed, uint64_t& generation, std::vector<Score>& scores) {
+        std::string request, reply;
+        ScoreProtocol::putU8(request, ScoreProtocol::FETCH);
+        ScoreProtocol::putU64(request, known);
+        if (!call(request, reply)) return false;
+
+        ScoreProtocol::Reader reader(reply);
+        uint8_t status;
+        uint32_t count;
+        changed = false;
+        if (reader.u8(status) && status == ScoreProtocol::UNCHANGED) {
+            return true;
+        }
+        if (status != ScoreProtocol::OK || !reader.u64(generation) || !reader.u32(count)) {
+            return false;
+        }
+        scores.clear();
+        std::string_view name, difficulty;
+        uint32_t timeMs;
+        while (count > 0 && reader.string(name) && reader.u32(timeMs) &&
+               reader.string(difficulty)) {
+            scores.push_back(Score{std::string(name), static_cast<int>(timeMs),
+                                   std::string(difficulty)});
+            count--;
+        }
+        changed = true;
+        return count == 0;
+    }
+
+    bool submit(const Score& score) {
+        std::string request, reply;
+        ScoreProtocol::putU8(request, ScoreProtocol::SUBMIT);
+        ScoreProtocol::putString(request, score.name);
+        ScoreProtocol::putU32(request, static_cast<uint32_t>(score.timeMs));
+        ScoreProtocol::putString(request, score.difficulty);
+        return call(request, reply) && static_cast<uint8_t>(reply[0]) == ScoreProtocol::OK;
+    }
+
+    // Writer thread: one submission, skipped once the daemon is known gone
+    void submitQueued(const Score& score) {
+        bool ok;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ok = !lost;
+        }
+        ok = ok && submit(score);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = std::find_if(sending.begin(), sending.end(), [&](const Score& queued) {
+            return queued.timeMs == score.timeMs && queued.name == score.name &&
+                   queued.difficulty == score.difficulty;
+        });
+        if (it != sending.end()) sending.erase(it);
+        if (!ok) {
+            lost = true;
+            unsent.push_back(score);
+        }
+    }
+
+    // Writer thread: leaves a newer table for the owner to take in
+    void fetchQueued(uint64_t known) {
+        bool ok;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ok = !lost;
+        }
+        bool changed = false;
+        uint64_t generation = 0;
+        std::vector<Score> scores;
+        ok = ok && fetch(known, changed, generation, scores);
+        std::lock_guard<std::mutex> lock(mutex);
+        fetching = false;
+        if (!ok) {
+            lost = true;
+        } else if (changed) {
+            table.swap(scores);
+            tableGeneration = generation;
+            tableReady = true;
+        }
+    }
+#endif
+};
+
+// Takes journal records, compactions and other tasks off the caller's
+// thread, in submission order; each wakeup drains the whole queue, so a
+// burst of records costs one append and one fsync.
+struct Highscores::Writer {
+#ifdef HIGHSCORES_THREADS
+    struct Job {
+        bool compact;
+        std::string record;
+        std::function<void()> task;  // Set for runInBackground() jobs
+    };
+
+    Store* store = nullptr;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> queue;
+    bool stopping = false;
+    std::thread thread;
+
+    // The store is opened by the first load, which may finish after the
+    // writer starts, so it comes with each job
+    void submit(Store* target, bool compact, std::string record) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            store = target;
+            queue.push_back(Job{compact, std::move(record), nullptr});
+        }
+        wake.notify_one();
+    }
 
-    if (!home) {
-        home = ".";
+    void submitTask(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            queue.push_back(Job{false, std::string(), std::move(task)});
+        }
+        wake.notify_one();
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_one();
+        thread.join();
     }
 
-    std::string dirPath = std::string(home) + PATH_SEP + ".minesweeper";
-    MKDIR(dirPath.c_str());
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;  // Stopping, and everything is written
+            std::deque<Job> batch;
+            batch.swap(queue);
+            lock.unlock();
+
+            std::vector<std::string> records;
+            for (auto& job : batch) {
+                if (!job.compact && !job.task) {
+                    records.push_back(std::move(job.record));
+                    continue;
+                }
+                // Records queued before a compaction or task land first, so
+                // the new snapshot includes them
+                if (!records.empty()) {
+                    store->append(records);
+                    records.clear();
+                }
+                if (job.task) {
+                    job.task();
+                } else {
+                    store->compact(false);
+                }
+            }
+            if (!records.empty()) {
+                store->append(records);
+            }
+
+            lock.lock();
+        }
+    }
+#endif
+};
+
+Highscores::Highscores()
+    : Highscores([] {
+        #ifdef _WIN32
+            const char* home = getenv("APPDATA");
+        #else
+            const char* home = getenv("HOME");
+        #endif
+
+        if (!home) {
+            home = ".";
+        }
+        return std::string(home) + PATH_SEP + ".minesweeper";
+    }()) {
+    shared = true;
+#ifdef HIGHSCORES_SERVER
+    const char* socketPath = getenv(ScoreProtocol::SOCKET_ENV);
+    serverPath = socketPath ? socketPath : ScoreProtocol::defaultSocket();
+#endif
+}
+
+Highscores::Highscores(const std::string& directory) : dirPath(directory) {
+    // Presets first so they are listed in this order
+    addKey("Easy");
+    addKey("Medium");
+    addKey("Hard");
+
     scorePath = dirPath + PATH_SEP + "scores.txt";
-    loadScores();
+    journalPath = dirPath + PATH_SEP + "scores.journal";
+    lockPath = dirPath + PATH_SEP + "scores.lock";
+}
+
+Highscores::~Highscores() {
+#ifdef HIGHSCORES_THREADS
+    if (writer) {
+        writer->stop();
+        writer.reset();
+    }
+    // A preload still running must not outlive the tables it fills
+    if (pendingLoad) {
+        pendingLoad->result.wait();
+    }
+#endif
+#ifdef HIGHSCORES_SERVER
+    // Scores the daemon never acknowledged are kept in the local files
+    if (server) {
+        std::vector<Score> unsent;
+        {
+            std::lock_guard<std::mutex> lock(server->mutex);
+            unsent.swap(server->unsent);
+        }
+        if (!unsent.empty()) {
+            server.reset();
+            loadScores();
+            for (const auto& score : unsent) {
+                addScore(score);
+            }
+        }
+    }
+#endif
+}
+
+void Highscores::preload() {
+#ifdef HIGHSCORES_THREADS
+    if (pendingLoad || loaded) return;
+    pendingLoad.reset(new PendingLoad);
+    pendingLoad->result = std::async(std::launch::async, [this] { loadScores(); });
+#endif
+}
+
+void Highscores::startBackgroundWriter() {
+#ifdef HIGHSCORES_THREADS
+    if (writer) return;
+    writer.reset(new Writer);
+    writer->thread = std::thread(&Writer::run, writer.get());
+#endif
+}
+
+void Highscores::runInBackground(std::function<void()> task) {
+#ifdef HIGHSCORES_THREADS
+    if (writer) {
+        writer->submitTask(std::move(task));
+        return;
+    }
+#endif
+    task();
+}
+
+void Highscores::setServer(const std::string& socketPath) {
+    serverPath = socketPath;
+    serverTried = false;
+}
+
+uint64_t Highscores::changes() const {
+    ensureLoaded();
+    return changeCount;
+}
+
+// Every public entry point goes through here first, so the loader thread is
+// the only one touching the tables until it has been joined.
+void Highscores::ensureLoaded() const {
+    if (pendingLoad) {
+#ifdef HIGHSCORES_THREADS
+        pendingLoad->result.wait();
+#endif
+        pendingLoad.reset();
+    }
+    if (!loaded) {
+        const_cast<Highscores*>(this)->loadScores();
+    } else {
+        const_cast<Highscores*>(this)->refresh();
+    }
+}
+
+// Picks up whatever has been stored since the tables were last brought up
+// to date, by other processes or by this one's writer. While nothing
+// changes this is one load of the shared generation counter; otherwise only
+// the new end of the journal is parsed, and just a compaction (which
+// replaces the files) forces a full reload.
+void Highscores::refresh() {
+    if (server) {
+#ifdef HIGHSCORES_SERVER
+        if (writer) {
+            pollServer();
+            return;
+        }
+#endif
+        // The daemon answers "unchanged" without resending anything
+        if (!fetchFromServer()) {
+            loadScores();
+        }
+        return;
+    }
+    if (!store) return;
+    uint64_t generation = loadShared(store->header->generation);
+    if (generation == seenGeneration) return;
+    uint64_t compactions = loadShared(store->header->compactions);
+    if (compactions != seenCompactions || !readJournalTail()) {
+        loadScores();
+        return;
+    }
+    seenGeneration = generation;
+    // A compaction that finished while the tail was read may have swapped
+    // the journal out from under it
+    if (loadShared(store->header->compactions) != compactions) {
+        loadScores();
+    }
+}
+
+DifficultyKey Highscores::internDifficulty(std::string_view difficulty) {
+    ensureLoaded();
+    return addKey(difficulty);
+}
+
+DifficultyKey Highscores::findDifficulty(std::string_view difficulty) const {
+    ensureLoaded();
+    return lookupKey(difficulty);
+}
+
+DifficultyKey Highscores::addKey(std::string_view difficulty) {
+    auto it = difficultyKeys.find(difficulty);
+    if (it != difficultyKeys.end()) {
+        return it->second;
+    }
+    if (difficultyNames.size() >= NO_DIFFICULTY) {
+        return NO_DIFFICULTY;
+    }
+    DifficultyKey key = static_cast<DifficultyKey>(difficultyNames.size());
+    difficultyNames.emplace_back(difficulty);
+    leaderboards.emplace_back(MAX_SCORES_PER_DIFFICULTY);
+    difficultyKeys.emplace(difficultyNames.back(), key);
+
+    BoardKey board;
+    if (parseBoardName(difficulty, board)) {
+        boardKeys.emplace(board, key);
+    }
+    return key;
+}
+
+DifficultyKey Highscores::lookupKey(std::string_view difficulty) const {
+    auto it = difficultyKeys.find(difficulty);
+    return it != difficultyKeys.end() ? it->second : NO_DIFFICULTY;
 }
 
 void Highscores::addScore(const Score& score) {
-    scores.push_back(score);
-    scoresByDifficulty[score.difficulty].push_back(score);
-    
-    // Sort scores for this difficulty by time
-    auto& difficultyScores = scoresByDifficulty[score.difficulty];
-    std::sort(difficultyScores.begin(), difficultyScores.end(),
-        [](const Score& a, const Score& b) {
-            return a.time < b.time;
-        });
-    
-    // Keep only top MAX_SCORES_PER_DIFFICULTY scores for this difficulty
-    if (difficultyScores.size() > MAX_SCORES_PER_DIFFICULTY) {
-        difficultyScores.resize(MAX_SCORES_PER_DIFFICULTY);
+    ensureLoaded();
+    if (server) {
+#ifdef HIGHSCORES_SERVER
+        if (writer) {
+            // Shown at once; the daemon hears of it from the writer thread
+            insertScore(score);
+            {
+                std::lock_guard<std::mutex> lock(server->mutex);
+                server->sending.push_back(score);
+            }
+            std::shared_ptr<Server> connection = server;
+            writer->submitTask([connection, score] { connection->submitQueued(score); });
+            return;
+        }
+#endif
+        if (submitToServer(score)) {
+            insertScore(score);
+            return;
+        }
+        loadScores();  // The daemon has gone; carry on with the local files
     }
-    
-    // Update main scores vector to reflect all difficulty-specific scores
-    scores.clear();
-    for (const auto& pair : scoresByDifficulty) {
-        scores.insert(scores.end(), pair.second.begin(), pair.second.end());
+    insertScore(score);
+    if (!store) return;
+
+    pendingOwn.push_back(score);
+    std::string record = score.name + '|' + std::to_string(score.timeMs) + '|' +
+                         score.difficulty + '\n';
+#ifdef HIGHSCORES_THREADS
+    if (writer) {
+        writer->submit(store.get(), false, std::move(record));
+    } else
+#endif
+    {
+        store->append(std::vector<std::string>(1, record));
+    }
+
+    if (!compactionRequested && journalEntries + pendingOwn.size() >= COMPACT_AFTER_ENTRIES) {
+        saveScores();
     }
-    
-    saveScores();
 }
 
-const std::vector<Score>& Highscores::getScores() const {
-    return scores;
+void Highscores::insertScore(const Score& score) {
+    DifficultyKey key = addKey(score.difficulty);
+    if (key != NO_DIFFICULTY && leaderboards[key].insert(score)) {
+        changeCount++;
+    }
+}
+
+// Loader path: the fields are views into the mapped file, and strings are
+// only built for entries that actually make it onto a leaderboard.
+void Highscores::insertParsed(std::string_view name, int time, std::string_view difficulty,
+                              bool fromTail) {
+    // Legacy whole seconds become milliseconds; clamp instead of overflowing
+    int timeMs = time <= INT_MAX / loadTimeScale ? time * loadTimeScale : INT_MAX;
+    if (!pendingOwn.empty() && claimPending(name, timeMs, difficulty) && fromTail) {
+        return;  // On the leaderboard since addScore()
+    }
+
+    DifficultyKey key = lookupKey(difficulty);
+    if (key == NO_DIFFICULTY) {
+        key = addKey(difficulty);
+        if (key == NO_DIFFICULTY) return;
+    }
+    if (!leaderboards[key].qualifies(timeMs)) return;
+
+    Score score;
+    score.name.assign(name.data(), name.size());
+    score.timeMs = timeMs;
+    score.difficulty = difficultyNames[key];
+    leaderboards[key].insert(score);
+    changeCount++;
+}
+
+// Marks one of this instance's own scores as read back from disk
+bool Highscores::claimPending(std::string_view name, int timeMs, std::string_view difficulty) {
+    auto it = std::find_if(pendingOwn.begin(), pendingOwn.end(), [&](const Score& score) {
+        return score.timeMs == timeMs && score.name == name && score.difficulty == difficulty;
+    });
+    if (it == pendingOwn.end()) return false;
+    pendingOwn.erase(it);
+    return true;
+}
+
+Highscores::ScoreView Highscores::getScores() const {
+    ensureLoaded();
+    return ScoreView(&leaderboards);
 }
 
 std::vector<Score> Highscores::getScoresByDifficulty(const std::string& difficulty) const {
-    auto it = scoresByDifficulty.find(difficulty);
-    if (it != scoresByDifficulty.end()) {
-        return it->second;
+    DifficultyKey key = findDifficulty(difficulty);
+    if (key != NO_DIFFICULTY) {
+        return leaderboards[key].entries();
     }
     return std::vector<Score>();
 }
 
-bool Highscores::isHighScore(int time, const std::string& difficulty) const {
-    auto it = scoresByDifficulty.find(difficulty);
-    if (it == scoresByDifficulty.end()) {
+bool Highscores::isHighScore(int timeMs, const std::string& difficulty) const {
+    DifficultyKey key = findDifficulty(difficulty);
+    if (key == NO_DIFFICULTY) {
         return true;  // First score for this difficulty
     }
-    
-    const auto& difficultyScores = it->second;
-    if (difficultyScores.size() < MAX_SCORES_PER_DIFFICULTY) {
-        return true;  // Less than max scores for this difficulty
+    return isHighScore(timeMs, key);
+}
+
+BoardKey Highscores::packBoard(int width, int height, int mines) {
+    return static_cast<BoardKey>(static_cast<uint16_t>(width)) << 48 |
+           static_cast<BoardKey>(static_cast<uint16_t>(height)) << 32 |
+           static_cast<uint32_t>(mines);
+}
+
+std::string Highscores::boardName(int width, int height, int mines) {
+    for (const auto& preset : PRESET_BOARDS) {
+        if (width == preset.width && height == preset.height && mines == preset.mines) {
+            return preset.name;
+        }
+    }
+    return CUSTOM_BOARD_PREFIX + std::to_string(width) + 'x' + std::to_string(height) + '/' +
+           std::to_string(mines);
+}
+
+// A single hash probe on the packed key; no name is built for the lookup
+DifficultyKey Highscores::findBoard(int width, int height, int mines) const {
+    ensureLoaded();
+    auto it = boardKeys.find(packBoard(width, height, mines));
+    return it != boardKeys.end() ? it->second : NO_DIFFICULTY;
+}
+
+bool Highscores::isHighScore(int timeMs, int width, int height, int mines) const {
+    DifficultyKey key = findBoard(width, height, mines);
+    if (key == NO_DIFFICULTY) {
+        return true;  // First score for this board
+    }
+    return isHighScore(timeMs, key);
+}
+
+bool Highscores::isHighScore(int timeMs, DifficultyKey difficulty) const {
+    ensureLoaded();
+    if (difficulty >= leaderboards.size()) {
+        return true;
     }
-    
-    return time < difficultyScores.back().time;  // Compare with worst time in top 10
+    // Compare with the current K-th (worst kept) time
+    return leaderboards[difficulty].qualifies(timeMs);
 }
 
 void Highscores::loadScores() {
-    std::ifstream file(scorePath);
-    if (!file) return;
-    
-    scores.clear();
-    scoresByDifficulty.clear();
-    
-    std::string line;
-    while (std::getline(file, line)) {
-        size_t pos1 = line.find('|');
-        size_t pos2 = line.find('|', pos1 + 1);
-        if (pos1 != std::string::npos && pos2 != std::string::npos) {
-            Score score;
-            score.name = line.substr(0, pos1);
-            score.time = std::stoi(line.substr(pos1 + 1, pos2 - pos1 - 1));
-            score.difficulty = line.substr(pos2 + 1);
-            scores.push_back(score);
-            scoresByDifficulty[score.difficulty].push_back(score);
+    loaded = true;
+    changeCount++;
+    if (shared && connectServer()) {
+        if (fetchFromServer()) return;
+    }
+    if (shared && !store) {
+        MKDIR(dirPath.c_str());
+        store.reset(new Store(*this));
+    }
+    if (store) {
+        // Read before the files, so anything stored meanwhile is picked up
+        // by the next refresh()
+        seenGeneration = loadShared(store->header->generation);
+        seenCompactions = loadShared(store->header->compactions);
+        compactionRequested = false;
+    }
+
+    for (auto& board : leaderboards) {
+        board = Leaderboard(MAX_SCORES_PER_DIFFICULTY);
+    }
+    snapshotSequence = 0;
+
+    const std::string_view formatTag(SNAPSHOT_FORMAT_TAG);
+    const std::string_view sequenceTag(SNAPSHOT_SEQUENCE_TAG);
+    MappedFile file(scorePath);
+    std::string_view text = file.contents();
+    std::string_view line;
+    int version = text.empty() ? SCORE_FORMAT_VERSION : 1;
+    if (nextLine(text, line, true) && line.substr(0, formatTag.size()) == formatTag) {
+        parseNumber(line.substr(formatTag.size()), version);
+    } else {
+        text = file.contents();  // No format line; rescan from the start
+    }
+    loadTimeScale = version >= 2 ? 1 : 1000;
+
+    while (nextLine(text, line, true)) {
+        if (line.substr(0, sequenceTag.size()) == sequenceTag) {
+            parseNumber(line.substr(sequenceTag.size()), snapshotSequence);
+            continue;
+        }
+        std::string_view name, difficulty;
+        int time;
+        if (parseScoreFields(line, name, time, difficulty)) {
+            insertParsed(name, time, difficulty, false);
         }
     }
-    
-    // Sort scores for each difficulty
-    for (auto& pair : scoresByDifficulty) {
-        auto& difficultyScores = pair.second;
-        std::sort(difficultyScores.begin(), difficultyScores.end(),
-            [](const Score& a, const Score& b) {
-                return a.time < b.time;
-            });
-        if (difficultyScores.size() > MAX_SCORES_PER_DIFFICULTY) {
-            difficultyScores.resize(MAX_SCORES_PER_DIFFICULTY);
+
+    loadJournal();
+    // Still on their way to disk
+    for (const auto& score : pendingOwn) {
+        insertScore(score);
+    }
+
+    // Rewrite a seconds-based file straight away so new journal records,
+    // which are in milliseconds, never extend it. The rewrite is an ordinary
+    // compaction, after which the files are read again.
+    if (loadTimeScale != 1) {
+        loadTimeScale = 1;
+        if (store && store->compact(true)) {
+            loadScores();
         }
     }
-    
-    // Rebuild main scores vector
-    scores.clear();
-    for (const auto& pair : scoresByDifficulty) {
-        scores.insert(scores.end(), pair.second.begin(), pair.second.end());
+}
+
+// Replays journal entries newer than the snapshot. Each record is
+// "sequence|name|time|difficulty\n"; a final line without its newline is a
+// write that was interrupted by a crash (or is still in progress) and is
+// left for later.
+void Highscores::loadJournal() {
+    appliedSequence = snapshotSequence;
+    journalEntries = 0;
+    journalOffset = 0;
+
+    MappedFile file(journalPath);
+    applyJournal(file.contents(), false);
+}
+
+// Reads only the records appended since the last look. Returns false when
+// the journal has been replaced by a shorter one, which needs a full load.
+bool Highscores::readJournalTail() {
+    MappedFile file(journalPath);
+    std::string_view text = file.contents();
+    if (text.size() < journalOffset) return false;
+    text.remove_prefix(journalOffset);
+    applyJournal(text, true);
+    return true;
+}
+
+void Highscores::applyJournal(std::string_view text, bool fromTail) {
+    size_t length = text.size();
+    std::string_view line;
+    while (nextLine(text, line, false)) {
+        unsigned long sequence;
+        std::string_view name, difficulty;
+        int time;
+        if (!parseJournalRecord(line, sequence, name, time, difficulty)) {
+            continue;
+        }
+
+        journalEntries++;
+        appliedSequence = std::max(appliedSequence, sequence);
+        if (sequence > snapshotSequence) {
+            insertParsed(name, time, difficulty, fromTail);
+        }
     }
+    journalOffset += length - text.size();
 }
 
-void Highscores::saveScores() {
-    std::ofstream file(scorePath);
-    if (!file) return;
-    
+bool Highscores::connectServer() {
+#ifdef HIGHSCORES_SERVER
+    if (server) return true;
+    if (serverTried || serverPath.empty()) return false;
+    serverTried = true;
+    std::unique_ptr<Server> connection(new Server);
+    if (!connection->connect(serverPath)) return false;
+    server = std::move(connection);
+    serverGeneration = 0;
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Replaces the tables with the daemon's, unless they are already current.
+// Any failure drops the connection for good.
+bool Highscores::fetchFromServer() {
+#ifdef HIGHSCORES_SERVER
+    bool changed;
+    uint64_t generation;
+    std::vector<Score> scores;
+    if (server->fetch(serverGeneration, changed, generation, scores)) {
+        if (changed) {
+            replaceWithServerTable(generation, scores);
+        }
+        return true;
+    }
+    server.reset();
+#endif
+    return false;
+}
+
+bool Highscores::submitToServer(const Score& score) {
+#ifdef HIGHSCORES_SERVER
+    if (server->submit(score)) {
+        return true;
+    }
+    server.reset();
+#else
+    (void)score;
+#endif
+    return false;
+}
+
+void Highscores::replaceWithServerTable(uint64_t generation, const std::vector<Score>& scores) {
+    for (auto& board : leaderboards) {
+        board = Leaderboard(MAX_SCORES_PER_DIFFICULTY);
+    }
     for (const auto& score : scores) {
-        file << score.name << '|' << score.time << '|' << score.difficulty << '\n';
+        insertScore(score);
+    }
+    serverGeneration = generation;
+    changeCount++;
+}
+
+// Takes in what the writer thread has fetched, then queues the next FETCH,
+// so the tables follow the daemon's generation without the caller ever
+// waiting on the socket. Once a background call has failed, the local files
+// take over, along with every score the daemon did not acknowledge.
+void Highscores::pollServer() {
+#ifdef HIGHSCORES_SERVER
+    std::vector<Score> unsent;
+    bool lost;
+    {
+        std::lock_guard<std::mutex> lock(server->mutex);
+        lost = server->lost;
+        if (lost) {
+            unsent = server->unsent;
+            unsent.insert(unsent.end(), server->sending.begin(), server->sending.end());
+            server->unsent.clear();
+            server->sending.clear();
+        } else if (server->tableReady) {
+            replaceWithServerTable(server->tableGeneration, server->table);
+            // Submitted after that FETCH was answered; still ours to show
+            for (const auto& score : server->sending) {
+                insertScore(score);
+            }
+            server->tableReady = false;
+        }
+        if (!lost && !server->fetching) {
+            server->fetching = true;
+            std::shared_ptr<Server> connection = server;
+            uint64_t known = serverGeneration;
+            writer->submitTask([connection, known] { connection->fetchQueued(known); });
+        }
+    }
+    if (lost) {
+        server.reset();
+        loadScores();
+        for (const auto& score : unsent) {
+            addScore(score);
+        }
+    }
+#endif
+}
+
+// Asks for a compaction; it runs under the store lock, on the writer thread
+// when there is one
+void Highscores::saveScores() {
+    compactionRequested = true;
+#ifdef HIGHSCORES_THREADS
+    if (writer) {
+        writer->submit(store.get(), true, std::string());
+        return;
+    }
+#endif
+    store->compact(false);
+}
+
+// Reads the leaderboards directly rather than through getScores(), so it
+// is also safe to call from the loader thread
+std::string Highscores::snapshotText() const {
+    std::string data = SNAPSHOT_FORMAT_TAG + std::to_string(SCORE_FORMAT_VERSION) + '\n' +
+                       SNAPSHOT_SEQUENCE_TAG + std::to_string(appliedSequence) + '\n';
+    for (const auto& score : ScoreView(&leaderboards)) {
+        data += score.name + '|' + std::to_string(score.timeMs) + '|' + score.difficulty + '\n';
     }
+    return data;
 }
@@ -1,29 +1,209 @@
 #pragma once
 #include <string>
+#include <string_view>
 #include <vector>
-#include <map>
+#include <deque>
+#include <unordered_map>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <functional>
 
 struct Score {
     std::string name;
-    int time;
+    int timeMs;  // Milliseconds from the first reveal to the last
     std::string difficulty;
 };
 
+// "MM:SS.mmm", as shown in the high score lists
+std::string formatScoreTime(int timeMs);
+
+// Interned difficulty name; an index into Highscores' leaderboard table
+typedef uint16_t DifficultyKey;
+
+// Board configuration packed as width << 48 | height << 32 | mines
+typedef uint64_t BoardKey;
+
+// Bounded top-K list kept sorted by time. A new entry is placed with a
+// binary search and at most K entries move, so the full list is never
+// re-sorted.
+class Leaderboard {
+public:
+    explicit Leaderboard(size_t capacity = 10);
+    bool insert(const Score& score);
+    bool qualifies(int timeMs) const;
+    const std::vector<Score>& entries() const { return scores; }
+
+private:
+    std::vector<Score> scores;
+    size_t capacity;
+};
+
 class Highscores {
 public:
+    // Read-only view over every leaderboard, in difficulty order, without
+    // copying any scores
+    class ScoreView {
+    public:
+        class iterator {
+        public:
+            iterator(const std::vector<Leaderboard>* boards, size_t board, size_t index);
+            const Score& operator*() const;
+            const Score* operator->() const;
+            iterator& operator++();
+            bool operator==(const iterator& other) const;
+            bool operator!=(const iterator& other) const;
+
+        private:
+            void skipEmpty();
+            const std::vector<Leaderboard>* boards;
+            size_t board;
+            size_t index;
+        };
+
+        explicit ScoreView(const std::vector<Leaderboard>* boards);
+        iterator begin() const;
+        iterator end() const;
+        size_t size() const;
+        bool empty() const;
+
+    private:
+        const std::vector<Leaderboard>* boards;
+    };
+
+    static const DifficultyKey NO_DIFFICULTY = 0xFFFF;
+
+    // Windows locks byte ranges, so writers of scores.lock lock this byte,
+    // past the mapped store header; anything else sharing the lock (the
+    // game history) must lock the same byte
+    static const uint32_t STORE_LOCK_OFFSET = 32;
+
+    // Only works out the file paths; nothing is read from disk until a
+    // score is first needed.
+    //
+    // Several processes may share the score files. Writers serialise on an
+    // advisory lock over scores.lock and only ever append; a generation
+    // counter mapped from the same file tells every reader when to pick up
+    // the new end of the journal, so readers never take the lock.
+    //
+    // Where a minesweeper-scored daemon is listening, the store is left to
+    // it: scores are submitted and read over its socket instead, and the
+    // local files are used again as soon as the daemon cannot be reached.
     Highscores();
+    ~Highscores();
+    Highscores(const Highscores&) = delete;
+    Highscores& operator=(const Highscores&) = delete;
+
+    // Starts loading on a background thread so the scores are ready by the
+    // time they are needed. Where threads are unavailable the load simply
+    // stays deferred to first use.
+    void preload();
+
+    // Hands journal appends and compactions to a background writer thread
+    // so addScore() never waits on the disk, and with a daemon every call
+    // to it too, so no query waits on the socket. New scores are visible in
+    // memory at once; anything still queued is written out by the
+    // destructor. A no-op where threads are unavailable.
+    void startBackgroundWriter();
+
+    // Runs task on the background writer after everything queued before
+    // it, for other per-user files that should stay off the caller's thread
+    // too. Runs it at once when there is no writer.
+    void runInBackground(std::function<void()> task);
+
+    // Socket of the daemon to try first; empty means always use the local
+    // files. Defaults to $MINESWEEPER_SCORED, else the per-user socket in
+    // $XDG_RUNTIME_DIR. Takes effect at the next load.
+    void setServer(const std::string& socketPath);
+
+    // Bumped whenever the leaderboards change, so a caller can tell whether
+    // something it derived from them is stale
+    uint64_t changes() const;
+
     void addScore(const Score& score);
-    const std::vector<Score>& getScores() const;
+    ScoreView getScores() const;
     std::vector<Score> getScoresByDifficulty(const std::string& difficulty) const;
-    bool isHighScore(int time, const std::string& difficulty) const;
+    bool isHighScore(int timeMs, const std::string& difficulty) const;
+    bool isHighScore(int timeMs, DifficultyKey difficulty) const;
+
+    // Where the score files live; other per-user data sits alongside them
+    const std::string& getDirectory() const { return dirPath; }
+
+    DifficultyKey internDifficulty(std::string_view difficulty);
+    DifficultyKey findDifficulty(std::string_view difficulty) const;
+
+    // Every board configuration has its own leaderboard. The three presets
+    // keep their names; any other board is stored as "Custom WxH/M".
+    static BoardKey packBoard(int width, int height, int mines);
+    static std::string boardName(int width, int height, int mines);
+    DifficultyKey findBoard(int width, int height, int mines) const;
+    bool isHighScore(int timeMs, int width, int height, int mines) const;
 
 private:
+    struct PendingLoad;
+    struct Writer;
+    struct Store;
+    struct Server;
+
+    // A private instance over the files in directory, used to read back what
+    // is on disk; it never opens the store or writes anything itself
+    explicit Highscores(const std::string& directory);
+
+    void ensureLoaded() const;
+    void refresh();
+    DifficultyKey lookupKey(std::string_view difficulty) const;
+    DifficultyKey addKey(std::string_view difficulty);
     void loadScores();
     void saveScores();
-    
+    void insertScore(const Score& score);
+    void insertParsed(std::string_view name, int time, std::string_view difficulty, bool fromTail);
+    bool claimPending(std::string_view name, int timeMs, std::string_view difficulty);
+    void loadJournal();
+    bool readJournalTail();
+    bool connectServer();
+    bool fetchFromServer();
+    bool submitToServer(const Score& score);
+    void replaceWithServerTable(uint64_t generation, const std::vector<Score>& scores);
+    void pollServer();
+    void applyJournal(std::string_view text, bool fromTail);
+    std::string snapshotText() const;
+
+    std::string dirPath;
     std::string scorePath;
-    std::vector<Score> scores;  // All scores
-    std::map<std::string, std::vector<Score>> scoresByDifficulty;  // Scores grouped by difficulty
+    std::string journalPath;
+    std::string lockPath;
+    std::vector<Leaderboard> leaderboards;  // Indexed by DifficultyKey
+    std::deque<std::string> difficultyNames;  // Indexed by DifficultyKey; never moves
+    std::unordered_map<std::string_view, DifficultyKey> difficultyKeys;  // Views into difficultyNames
+    std::unordered_map<BoardKey, DifficultyKey> boardKeys;  // Boards whose name could be parsed
     const size_t MAX_SCORES_PER_DIFFICULTY = 10;
-};
 
+    // Every new score is appended to the journal; the snapshot in scorePath
+    // is only rewritten (atomically) once the journal grows past this size.
+    const size_t COMPACT_AFTER_ENTRIES = 64;
+    unsigned long snapshotSequence = 0;  // Last journal entry folded into the snapshot
+    unsigned long appliedSequence = 0;   // Highest journal entry read so far
+    size_t journalEntries = 0;
+    size_t journalOffset = 0;  // Journal bytes read, up to the last complete record
+    int loadTimeScale = 1;  // 1000 while reading a file that still stores seconds
+
+    // Scores added here that have not been read back from the journal yet.
+    // They are already on the leaderboards, so their journal records are
+    // skipped when they turn up.
+    std::vector<Score> pendingOwn;
+    uint64_t seenGeneration = 0;   // Store generation the tables reflect
+    uint64_t seenCompactions = 0;
+    bool compactionRequested = false;
+    bool shared = false;  // False for the private read-back instances
+    uint64_t changeCount = 0;
+
+    std::string serverPath;
+    uint64_t serverGeneration = 0;  // Daemon generation the tables reflect
+    bool serverTried = false;       // A connection failed or was lost; stay local
+
+    mutable bool loaded = false;
+    mutable std::unique_ptr<PendingLoad> pendingLoad;  // Set while a preload runs
+    std::unique_ptr<Store> store;    // Opened by the first load
+    std::shared_ptr<Server> server;  // Set while the daemon holds the scores; shared with queued calls
+    std::unique_ptr<Writer> writer;  // Set once writes go to the background
+};
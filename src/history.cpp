@@ -0,0 +1,438 @@
+#include "history.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+    #include <direct.h>
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #include <windows.h>
+    #define MKDIR(dir) _mkdir(dir)
+    #define PATH_SEP "\\"
+#else
+    #include <sys/stat.h>
+    #include <sys/types.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <cerrno>
+    #ifndef MSDOS
+        #include <sys/file.h>
+    #endif
+    #define MKDIR(dir) mkdir(dir, 0700)
+    #define PATH_SEP "/"
+#endif
+
+// Neither DJGPP nor C++/CLI (/clr) builds provide <future>
+#if !defined(MSDOS) && !defined(_M_CEE)
+    #define HISTORY_THREADS
+    #include <future>
+#endif
+
+namespace {
+    const char* const BOARD_COLUMN = "history.board";
+    const char* const TIME_COLUMN = "history.time";
+    const char* const BBBV_COLUMN = "history.3bv";
+    const char* const CLICK_COLUMN = "history.clicks";
+    const char* const OUTCOME_COLUMN = "history.outcome";
+    const char* const DATE_COLUMN = "history.date";
+
+    template <typename T>
+    void putLE(std::vector<uint8_t>& out, T value) {
+        for (size_t i = 0; i < sizeof(T); i++) {
+            out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+        }
+    }
+
+    template <typename T>
+    std::vector<T> readColumn(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)),
+                                   std::istreambuf_iterator<char>());
+        std::vector<T> column(bytes.size() / sizeof(T));
+        for (size_t row = 0; row < column.size(); row++) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < sizeof(T); i++) {
+                value |= static_cast<uint64_t>(bytes[row * sizeof(T) + i]) << (8 * i);
+            }
+            column[row] = static_cast<T>(value);
+        }
+        return column;
+    }
+
+    template <typename T>
+    void writeColumn(const std::string& path, const T* values, size_t count, bool append) {
+        std::vector<uint8_t> out;
+        out.reserve(count * sizeof(T));
+        for (size_t row = 0; row < count; row++) {
+            putLE(out, values[row]);
+        }
+        std::ofstream file(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+        file.write(reinterpret_cast<const char*>(out.data()), out.size());
+    }
+
+    // Holds the advisory lock on scores.lock, the one the score writers
+    // take, while it is in scope. A row goes to six files, so without it
+    // appends from two processes could interleave, and a repair in load()
+    // could cut back rows another process is still writing. Does nothing
+    // under DOS or when the file cannot be opened.
+    class HistoryLock {
+    public:
+        explicit HistoryLock(const std::string& directory) {
+            std::string path = directory + PATH_SEP + "scores.lock";
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ | GENERIC_WRITE,
+                               FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+                               OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file != INVALID_HANDLE_VALUE) {
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = Highscores::STORE_LOCK_OFFSET;
+                LockFileEx(file, LOCKFILE_EXCLUSIVE_LOCK, 0, 1, 0, &overlapped);
+            }
+#elif !defined(MSDOS)
+            fd = open(path.c_str(), O_RDWR | O_CREAT, 0600);
+            if (fd >= 0) {
+                while (flock(fd, LOCK_EX) != 0 && errno == EINTR) {}
+            }
+#else
+            (void)path;
+#endif
+        }
+
+        ~HistoryLock() {
+#ifdef _WIN32
+            if (file != INVALID_HANDLE_VALUE) {
+                OVERLAPPED overlapped = {};
+                overlapped.Offset = Highscores::STORE_LOCK_OFFSET;
+                UnlockFileEx(file, 0, 1, 0, &overlapped);
+                CloseHandle(file);
+            }
+#elif !defined(MSDOS)
+            if (fd >= 0) {
+                close(fd);  // Releases the lock
+            }
+#endif
+        }
+
+        HistoryLock(const HistoryLock&) = delete;
+        HistoryLock& operator=(const HistoryLock&) = delete;
+
+    private:
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+#elif !defined(MSDOS)
+        int fd = -1;
+#endif
+    };
+
+    // Adds one game to the end of every column file
+    void appendRow(const std::string& directory, const GameRecord& game) {
+        MKDIR(directory.c_str());
+        HistoryLock lock(directory);
+        uint8_t outcome = static_cast<uint8_t>(game.outcome);
+        std::string prefix = directory + PATH_SEP;
+        writeColumn(prefix + BOARD_COLUMN, &game.board, 1, true);
+        writeColumn(prefix + TIME_COLUMN, &game.timeMs, 1, true);
+        writeColumn(prefix + BBBV_COLUMN, &game.bbbv, 1, true);
+        writeColumn(prefix + CLICK_COLUMN, &game.clicks, 1, true);
+        writeColumn(prefix + OUTCOME_COLUMN, &outcome, 1, true);
+        writeColumn(prefix + DATE_COLUMN, &game.date, 1, true);
+    }
+
+    // Number of bits needed to hold value
+    int bitLength(uint32_t value) {
+        int bits = 0;
+        while (value) {
+            bits++;
+            value >>= 1;
+        }
+        return bits;
+    }
+}
+
+uint32_t count3BV(const std::vector<std::vector<bool>>& minefield) {
+    int height = static_cast<int>(minefield.size());
+    if (height == 0) return 0;
+    int width = static_cast<int>(minefield[0].size());
+
+    // Adjacent mine counts, then one flood per opening marks what it uncovers
+    std::vector<int> adjacent(height * width, 0);
+    for (int row = 0; row < height; row++) {
+        for (int col = 0; col < width; col++) {
+            if (!minefield[row][col]) continue;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int y = row + dy;
+                    int x = col + dx;
+                    if (y >= 0 && y < height && x >= 0 && x < width) {
+                        adjacent[y * width + x]++;
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t clicks = 0;
+    std::vector<uint8_t> uncovered(height * width, 0);
+    std::vector<int> stack;
+    for (int start = 0; start < height * width; start++) {
+        if (uncovered[start] || adjacent[start] != 0 || minefield[start / width][start % width]) {
+            continue;
+        }
+        clicks++;
+        uncovered[start] = 1;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            int cell = stack.back();
+            stack.pop_back();
+            if (adjacent[cell] != 0) continue;
+            int row = cell / width;
+            int col = cell % width;
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int y = row + dy;
+                    int x = col + dx;
+                    if (y < 0 || y >= height || x < 0 || x >= width) continue;
+                    int next = y * width + x;
+                    if (!uncovered[next] && !minefield[y][x]) {
+                        uncovered[next] = 1;
+                        stack.push_back(next);
+                    }
+                }
+            }
+        }
+    }
+
+    for (int cell = 0; cell < height * width; cell++) {
+        if (!uncovered[cell] && !minefield[cell / width][cell % width]) {
+            clicks++;
+        }
+    }
+    return clicks;
+}
+
+// TimeHistogram implementation
+int TimeHistogram::bucketOf(uint32_t timeMs) {
+    if (timeMs < SUB_BUCKETS) {
+        return static_cast<int>(timeMs);
+    }
+    int shift = bitLength(timeMs) - 7;  // Keep the top 7 bits: 1 implicit + 6
+    return (shift + 1) * SUB_BUCKETS + static_cast<int>((timeMs >> shift) & (SUB_BUCKETS - 1));
+}
+
+uint32_t TimeHistogram::bucketLowerBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return static_cast<uint32_t>(bucket);
+    }
+    int shift = bucket / SUB_BUCKETS - 1;
+    return static_cast<uint32_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+void TimeHistogram::add(uint32_t timeMs) {
+    if (counts.empty()) {
+        counts.assign(BUCKETS, 0);
+    }
+    counts[bucketOf(timeMs)]++;
+    total++;
+}
+
+void TimeHistogram::merge(const TimeHistogram& other) {
+    if (other.total == 0) return;
+    if (counts.empty()) {
+        counts.assign(BUCKETS, 0);
+    }
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        counts[bucket] += other.counts[bucket];
+    }
+    total += other.total;
+}
+
+double TimeHistogram::fractionSlower(uint32_t timeMs) const {
+    if (total == 0) return 0.0;
+    uint64_t slower = 0;
+    for (int bucket = bucketOf(timeMs) + 1; bucket < BUCKETS; bucket++) {
+        slower += counts[bucket];
+    }
+    return static_cast<double>(slower) / total;
+}
+
+uint32_t TimeHistogram::quantile(double q) const {
+    if (total == 0) return 0;
+    q = std::min(std::max(q, 0.0), 1.0);
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += counts[bucket];
+        if (seen >= target) {
+            return bucketLowerBound(bucket);
+        }
+    }
+    return bucketLowerBound(BUCKETS - 1);
+}
+
+// GameHistory implementation
+struct GameHistory::PendingLoad {
+#ifdef HISTORY_THREADS
+    std::future<void> result;
+#endif
+};
+
+GameHistory::GameHistory(const std::string& directory) : directory(directory) {}
+
+GameHistory::~GameHistory() {
+    // A preload still running must not outlive the columns it fills
+#ifdef HISTORY_THREADS
+    if (pendingLoad) {
+        pendingLoad->result.wait();
+    }
+#endif
+}
+
+void GameHistory::preload() {
+#ifdef HISTORY_THREADS
+    if (pendingLoad || loaded) return;
+    pendingLoad.reset(new PendingLoad);
+    pendingLoad->result = std::async(std::launch::async, [this] { load(); });
+#endif
+}
+
+void GameHistory::writeInBackground(Highscores& scores) {
+    writer = &scores;
+}
+
+// Every public entry point goes through here first, so the loader thread is
+// the only one touching the columns until it has been joined
+void GameHistory::ensureLoaded() const {
+    if (pendingLoad) {
+#ifdef HISTORY_THREADS
+        pendingLoad->result.wait();
+#endif
+        pendingLoad.reset();
+    }
+    if (!loaded) {
+        const_cast<GameHistory*>(this)->load();
+    }
+}
+
+// Reads and repairs under the lock, so no other process is part way
+// through an append
+void GameHistory::load() {
+    loaded = true;
+    HistoryLock lock(directory);
+    std::string prefix = directory + PATH_SEP;
+    boardColumn = readColumn<BoardKey>(prefix + BOARD_COLUMN);
+    timeColumn = readColumn<uint32_t>(prefix + TIME_COLUMN);
+    bbbvColumn = readColumn<uint32_t>(prefix + BBBV_COLUMN);
+    clickColumn = readColumn<uint32_t>(prefix + CLICK_COLUMN);
+    outcomeColumn = readColumn<uint8_t>(prefix + OUTCOME_COLUMN);
+    dateColumn = readColumn<uint32_t>(prefix + DATE_COLUMN);
+
+    size_t rows = std::min({boardColumn.size(), timeColumn.size(), bbbvColumn.size(),
+                            clickColumn.size(), outcomeColumn.size(), dateColumn.size()});
+    bool torn = rows != boardColumn.size() || rows != timeColumn.size() ||
+                rows != bbbvColumn.size() || rows != clickColumn.size() ||
+                rows != outcomeColumn.size() || rows != dateColumn.size();
+    boardColumn.resize(rows);
+    timeColumn.resize(rows);
+    bbbvColumn.resize(rows);
+    clickColumn.resize(rows);
+    outcomeColumn.resize(rows);
+    dateColumn.resize(rows);
+
+    // An interrupted append left some columns a row ahead; cut them back so
+    // the next append lines up again
+    if (torn) {
+        writeColumn(prefix + BOARD_COLUMN, boardColumn.data(), rows, false);
+        writeColumn(prefix + TIME_COLUMN, timeColumn.data(), rows, false);
+        writeColumn(prefix + BBBV_COLUMN, bbbvColumn.data(), rows, false);
+        writeColumn(prefix + CLICK_COLUMN, clickColumn.data(), rows, false);
+        writeColumn(prefix + OUTCOME_COLUMN, outcomeColumn.data(), rows, false);
+        writeColumn(prefix + DATE_COLUMN, dateColumn.data(), rows, false);
+    }
+
+    for (size_t row = 0; row < rows; row++) {
+        index(row);
+    }
+}
+
+void GameHistory::index(size_t row) {
+    if (outcomeColumn[row] == static_cast<uint8_t>(GameOutcome::WON)) {
+        winHistograms[boardColumn[row]].add(timeColumn[row]);
+    }
+}
+
+// Loading has finished before the row is appended, so load() can never
+// read it back a second time
+void GameHistory::record(const GameRecord& game) {
+    ensureLoaded();
+    boardColumn.push_back(game.board);
+    timeColumn.push_back(game.timeMs);
+    bbbvColumn.push_back(game.bbbv);
+    clickColumn.push_back(game.clicks);
+    outcomeColumn.push_back(static_cast<uint8_t>(game.outcome));
+    dateColumn.push_back(game.date);
+    index(boardColumn.size() - 1);
+
+    if (writer) {
+        std::string path = directory;
+        writer->runInBackground([path, game] { appendRow(path, game); });
+    } else {
+        appendRow(directory, game);
+    }
+}
+
+size_t GameHistory::size() const {
+    ensureLoaded();
+    return boardColumn.size();
+}
+
+const TimeHistogram* GameHistory::winTimes(BoardKey board) const {
+    ensureLoaded();
+    auto it = winHistograms.find(board);
+    return it != winHistograms.end() ? &it->second : nullptr;
+}
+
+double GameHistory::fractionSlower(BoardKey board, uint32_t timeMs) const {
+    const TimeHistogram* histogram = winTimes(board);
+    return histogram ? histogram->fractionSlower(timeMs) : 0.0;
+}
+
+uint32_t GameHistory::quantile(BoardKey board, double q) const {
+    const TimeHistogram* histogram = winTimes(board);
+    return histogram ? histogram->quantile(q) : 0;
+}
+
+const std::vector<BoardKey>& GameHistory::boards() const {
+    ensureLoaded();
+    return boardColumn;
+}
+
+const std::vector<uint32_t>& GameHistory::times() const {
+    ensureLoaded();
+    return timeColumn;
+}
+
+const std::vector<uint32_t>& GameHistory::bbbvs() const {
+    ensureLoaded();
+    return bbbvColumn;
+}
+
+const std::vector<uint32_t>& GameHistory::clickCounts() const {
+    ensureLoaded();
+    return clickColumn;
+}
+
+const std::vector<uint8_t>& GameHistory::outcomes() const {
+    ensureLoaded();
+    return outcomeColumn;
+}
+
+const std::vector<uint32_t>& GameHistory::dates() const {
+    ensureLoaded();
+    return dateColumn;
+}
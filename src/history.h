@@ -0,0 +1,112 @@
+#pragma once
+#include "highscores.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <cstddef>
+#include <cstdint>
+
+enum class GameOutcome : uint8_t {
+    LOST = 0,
+    WON = 1
+};
+
+struct GameRecord {
+    BoardKey board;
+    uint32_t timeMs;
+    uint32_t bbbv;    // 3BV: the minimum number of clicks that clears the board
+    uint32_t clicks;
+    GameOutcome outcome;
+    uint32_t date;    // Unix time the game ended
+};
+
+// 3BV of a board: one click per opening plus one per numbered cell that no
+// opening uncovers
+uint32_t count3BV(const std::vector<std::vector<bool>>& minefield);
+
+// Log-linear histogram of game times: 64 sub-buckets per power of two, so
+// any value is placed within 1.6% of its true size. Two histograms merge by
+// adding their counts, and queries never look at individual games.
+class TimeHistogram {
+public:
+    static const int SUB_BUCKETS = 64;
+    static const int BUCKETS = 27 * SUB_BUCKETS;  // Values below 64, then 2^6 .. 2^31
+
+    void add(uint32_t timeMs);
+    void merge(const TimeHistogram& other);
+    uint64_t count() const { return total; }
+
+    // Fraction of recorded times slower than timeMs, in [0, 1]
+    double fractionSlower(uint32_t timeMs) const;
+    // Time below which a fraction q of the recorded times fall, rounded down
+    // to its bucket
+    uint32_t quantile(double q) const;
+
+    static int bucketOf(uint32_t timeMs);
+    static uint32_t bucketLowerBound(int bucket);
+
+private:
+    std::vector<uint32_t> counts;  // Allocated on first add
+    uint64_t total = 0;
+};
+
+// Every finished game, won or lost, kept in an append-only columnar log:
+// one file per field (history.board, history.time, ...) next to the score
+// files, each a packed little-endian array. A torn append leaves one column
+// longer than the rest; only the common prefix is kept. Loading is deferred
+// to the first query, and a histogram of winning times is kept per board.
+class GameHistory {
+public:
+    explicit GameHistory(const std::string& directory);
+    ~GameHistory();
+    GameHistory(const GameHistory&) = delete;
+    GameHistory& operator=(const GameHistory&) = delete;
+
+    // Starts loading on a background thread so the history is ready by the
+    // time it is queried. Where threads are unavailable the load simply
+    // stays deferred to first use.
+    void preload();
+
+    // Leaves the appends record() makes to the background writer of scores,
+    // which must outlive this history. The new game is in the histograms
+    // at once either way.
+    void writeInBackground(Highscores& scores);
+
+    void record(const GameRecord& game);
+    size_t size() const;
+
+    // Fraction of earlier wins on this board that were slower than timeMs
+    double fractionSlower(BoardKey board, uint32_t timeMs) const;
+    // Winning time at quantile q on this board; 0 when there are no wins
+    uint32_t quantile(BoardKey board, double q) const;
+    const TimeHistogram* winTimes(BoardKey board) const;
+
+    // Column views, all of length size()
+    const std::vector<BoardKey>& boards() const;
+    const std::vector<uint32_t>& times() const;
+    const std::vector<uint32_t>& bbbvs() const;
+    const std::vector<uint32_t>& clickCounts() const;
+    const std::vector<uint8_t>& outcomes() const;
+    const std::vector<uint32_t>& dates() const;
+
+private:
+    struct PendingLoad;
+
+    void ensureLoaded() const;
+    void load();
+    void index(size_t row);
+
+    std::string directory;
+    mutable bool loaded = false;
+    mutable std::unique_ptr<PendingLoad> pendingLoad;  // Set while a preload runs
+    Highscores* writer = nullptr;
+
+    std::vector<BoardKey> boardColumn;
+    std::vector<uint32_t> timeColumn;
+    std::vector<uint32_t> bbbvColumn;
+    std::vector<uint32_t> clickColumn;
+    std::vector<uint8_t> outcomeColumn;
+    std::vector<uint32_t> dateColumn;
+    std::unordered_map<BoardKey, TimeHistogram> winHistograms;
+};
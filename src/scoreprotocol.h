@@ -0,0 +1,111 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+// Wire protocol between Highscores and the minesweeper-scored daemon, over
+// a Unix domain socket. Every message is a frame: a u32 payload length,
+// then the payload. A request payload starts with its opcode and a reply
+// payload with a status. Integers are little-endian; strings are a u16
+// length followed by the bytes.
+//
+//   SUBMIT  string name, u32 timeMs, string difficulty
+//           -> status
+//   FETCH   u64 generation the client already has
+//           -> status; unless UNCHANGED: u64 generation, u32 count, then
+//              count x (string name, u32 timeMs, string difficulty)
+namespace ScoreProtocol {
+    const char* const SOCKET_NAME = "minesweeper-scored.sock";
+    const char* const SOCKET_ENV = "MINESWEEPER_SCORED";  // Empty disables the daemon
+    const uint32_t MAX_FRAME = 16 << 20;
+
+    // Socket used when SOCKET_ENV is not set: one inside $XDG_RUNTIME_DIR,
+    // which only its own user can enter, so nobody else can stand in for
+    // the daemon. Empty, meaning no daemon, when that variable is not set.
+    inline std::string defaultSocket() {
+        const char* runtime = getenv("XDG_RUNTIME_DIR");
+        if (!runtime || !*runtime) return std::string();
+        return std::string(runtime) + "/" + SOCKET_NAME;
+    }
+
+    enum Opcode : uint8_t {
+        SUBMIT = 1,
+        FETCH = 2
+    };
+
+    enum Status : uint8_t {
+        OK = 0,
+        UNCHANGED = 1,
+        BAD_REQUEST = 2
+    };
+
+    inline void putU8(std::string& out, uint8_t value) {
+        out.push_back(static_cast<char>(value));
+    }
+
+    inline void putU16(std::string& out, uint16_t value) {
+        for (int i = 0; i < 2; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    inline void putU32(std::string& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    inline void putU64(std::string& out, uint64_t value) {
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<char>(value >> (8 * i)));
+    }
+
+    // Longer strings are cut at 64K; names and difficulties never get close
+    inline void putString(std::string& out, std::string_view value) {
+        size_t length = value.size() < 0xFFFF ? value.size() : 0xFFFF;
+        putU16(out, static_cast<uint16_t>(length));
+        out.append(value.data(), length);
+    }
+
+    // Wraps a finished payload in its length prefix
+    inline std::string frame(const std::string& payload) {
+        std::string out;
+        out.reserve(4 + payload.size());
+        putU32(out, static_cast<uint32_t>(payload.size()));
+        return out + payload;
+    }
+
+    // Bounds-checked cursor over a received payload; every getter fails
+    // once the payload runs out
+    class Reader {
+    public:
+        explicit Reader(std::string_view data) : data(data) {}
+
+        bool u8(uint8_t& value) { return get(value, 1); }
+        bool u16(uint16_t& value) { return get(value, 2); }
+        bool u32(uint32_t& value) { return get(value, 4); }
+        bool u64(uint64_t& value) { return get(value, 8); }
+
+        bool string(std::string_view& value) {
+            uint16_t length;
+            if (!u16(length) || data.size() < length) return false;
+            value = data.substr(0, length);
+            data.remove_prefix(length);
+            return true;
+        }
+
+        bool done() const { return data.empty(); }
+
+    private:
+        template <typename T>
+        bool get(T& value, size_t bytes) {
+            if (data.size() < bytes) return false;
+            uint64_t result = 0;
+            for (size_t i = 0; i < bytes; i++) {
+                result |= static_cast<uint64_t>(static_cast<uint8_t>(data[i])) << (8 * i);
+            }
+            value = static_cast<T>(result);
+            data.remove_prefix(bytes);
+            return true;
+        }
+
+        std::string_view data;
+    };
+}
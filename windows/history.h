@@ -0,0 +1 @@
+../src/history.h
\ No newline at end of file
@@ -25,7 +25,7 @@ public:
   void setSeed(int seed) { currentSeed = seed; }
   int getSeed() { return currentSeed; }
 
-  const std::vector<Score> &GetNativeHighscores() {
+  Highscores::ScoreView GetNativeHighscores() {
     return nativeMinesweeper->highscores
         .getScores(); // use nativeMinesweeper pointer
   }
@@ -62,6 +62,7 @@ public:
   void RevealAdjacent(int row, int col) {
     if (!nativeMinesweeper->revealed[row][col])
       return;
+    nativeMinesweeper->clicks++;
 
     int mineCount = GetAdjacentMines(row, col);
     int flagCount = GetAdjacentFlags(row, col);
@@ -108,23 +109,8 @@ public:
     }
   }
 
-  bool IsHighScore(int time) {
-    std::string difficulty;
-    switch (nativeMinesweeper->width) {
-    case 9:
-      difficulty = "Easy";
-      break;
-    case 16:
-      difficulty = "Medium";
-      break;
-    case 30:
-      difficulty = "Hard";
-      break;
-    default:
-      difficulty = "Custom";
-      break;
-    }
-    return nativeMinesweeper->isHighScore(time, difficulty);
+  bool IsHighScore(int timeMs) {
+    return nativeMinesweeper->isHighScore(timeMs);
   }
 
   void SaveHighScore(String ^ name) {
@@ -140,8 +126,7 @@ public:
         for (const auto &score : nativeScores) {
           String ^ scoreStr = String::Format(
               "{0,-20} {1,-10} {2,-10}", gcnew String(score.name.c_str()),
-              (score.time / 60).ToString("D2") + ":" +
-                  (score.time % 60).ToString("D2"),
+              gcnew String(formatScoreTime(score.timeMs).c_str()),
               gcnew String(score.difficulty.c_str()));
           scores->Add(scoreStr);
         }
@@ -149,6 +134,7 @@ public:
       }
 
       void RevealCell(int row, int col) {
+    nativeMinesweeper->clicks++;
     if (nativeMinesweeper->firstMove) {
       nativeMinesweeper->initializeMinefield(row, col, getSeed());
       nativeMinesweeper->firstMove = false;
@@ -173,6 +159,7 @@ public:
 
   void ToggleFlag(int row, int col) {
     if (!nativeMinesweeper->revealed[row][col]) {
+      nativeMinesweeper->clicks++;
       nativeMinesweeper->flagged[row][col] =
           !nativeMinesweeper->flagged[row][col];
     }
@@ -203,6 +190,32 @@ public:
         return gcnew String(nativeMinesweeper->timer.getTimeString().c_str());
       }
 
+  String ^
+      GetPreciseTime() {
+        return gcnew String(
+            formatScoreTime(nativeMinesweeper->timer.getElapsedMillis()).c_str());
+      }
+
+  int GetElapsedMillis() { return nativeMinesweeper->timer.getElapsedMillis(); }
+
+  // Appends the finished game to the history. For a win, returns the share
+  // of earlier wins on this board that were slower, or -1 if there were none.
+  int RecordGame() {
+    Minesweeper *game = nativeMinesweeper;
+    if (!game->won) {
+      game->recordGame(GameOutcome::LOST);
+      return -1;
+    }
+    BoardKey board = Highscores::packBoard(game->width, game->height, game->mines);
+    int percentSlower = -1;
+    if (game->history.winTimes(board)) {
+      percentSlower = static_cast<int>(
+          game->history.fractionSlower(board, game->timer.getElapsedMillis()) * 100);
+    }
+    game->recordGame(GameOutcome::WON);
+    return percentSlower;
+  }
+
       void Reset() {
     nativeMinesweeper->reset();
   }
@@ -443,14 +456,19 @@ LYx9Yppc2K6rnkZS3u1c8sXk6BRi54Lg1mbtV/gBxfI7i3nTTAoAAAAASUVORK5CYII=)";
     if (gameEndHandled)
       return;
     gameEndHandled = true;
+    int percentSlower = minesweeper->RecordGame();
 
     if (minesweeper->IsGameOver()) {
       UpdateStatus("Game Over!");
     } else if (minesweeper->HasWon()) {
-      UpdateStatus("Congratulations! You've won!");
-      if (minesweeper->IsHighScore(
-              int ::Parse(minesweeper->GetTime()->Split(':')[0]) * 60 +
-              int ::Parse(minesweeper->GetTime()->Split(':')[1]))) {
+      if (percentSlower >= 0) {
+        UpdateStatus(String::Format(
+            "Congratulations! You've won! Faster than {0}% of your earlier wins.",
+            percentSlower));
+      } else {
+        UpdateStatus("Congratulations! You've won!");
+      }
+      if (minesweeper->IsHighScore(minesweeper->GetElapsedMillis())) {
         ShowHighScoreEntry();
       } else {
         ShowHighScores();
@@ -868,7 +886,7 @@ LYx9Yppc2K6rnkZS3u1c8sXk6BRi54Lg1mbtV/gBxfI7i3nTTAoAAAAASUVORK5CYII=)";
     highScoreForm->MinimizeBox = false;
 
     Label ^ timeLabel = gcnew Label();
-    timeLabel->Text = "Your time: " + minesweeper->GetTime();
+    timeLabel->Text = "Your time: " + minesweeper->GetPreciseTime();
     timeLabel->Location = Point(20, 20);
     timeLabel->AutoSize = true;
     highScoreForm->Controls->Add(timeLabel);
@@ -925,12 +943,10 @@ LYx9Yppc2K6rnkZS3u1c8sXk6BRi54Lg1mbtV/gBxfI7i3nTTAoAAAAASUVORK5CYII=)";
     highScoreList->Columns->Add("Difficulty", 100);
 
     // Get the actual scores from the native Highscores class
-    const std::vector<Score> &nativeScores = minesweeper->GetNativeHighscores();
+    Highscores::ScoreView nativeScores = minesweeper->GetNativeHighscores();
 
     for (const auto &score : nativeScores) {
-      int minutes = score.time / 60;
-      int seconds = score.time % 60;
-      String ^ timeStr = String::Format("{0:D2}:{1:D2}", minutes, seconds);
+      String ^ timeStr = gcnew String(formatScoreTime(score.timeMs).c_str());
 
       ListViewItem ^ item = gcnew ListViewItem(
           gcnew array<String ^>{gcnew String(score.name.c_str()), timeStr,
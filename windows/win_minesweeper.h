@@ -3,6 +3,7 @@
 #include <vector>
 #include <chrono>
 #include "highscores.h"
+#include "history.h"
 
 enum class Difficulty {
     EASY,    // 9x9, 10 mines
@@ -22,17 +23,22 @@ const DifficultySettings DIFFICULTY_SETTINGS[] = {
     {16, 30, 99}   // HARD
 };
 
+// Monotonic game clock. The full steady_clock resolution is kept and only
+// rounded down when read, so scores are exact to the millisecond.
 class GameTimer {
 private:
     std::chrono::steady_clock::time_point startTime;
-    bool running;
-    int elapsedSeconds;
+    std::chrono::steady_clock::duration elapsed{};
+    bool running = false;
+
+    std::chrono::steady_clock::duration current() const;
 
 public:
     void start();
     void stop();
     std::string getTimeString() const;
     int getElapsedSeconds() const;
+    int getElapsedMillis() const;
 };
 
 class Minesweeper {
@@ -44,6 +50,8 @@ public:
     std::string playerName;
     GameTimer timer;
     Highscores highscores;
+    GameHistory history;  // Declared after highscores, whose directory it shares
+    int clicks;
     std::vector<std::vector<bool>> minefield;
     std::vector<std::vector<bool>> revealed;
     std::vector<std::vector<bool>> flagged;
@@ -56,8 +64,9 @@ public:
     void revealCell(int row, int col);
     void revealAllMines();
     bool checkWin();
-    bool isHighScore(int time, const std::string& difficulty);
+    bool isHighScore(int timeMs);
     void saveHighscore();
+    void recordGame(GameOutcome outcome);
 };
 
 namespace MinesweeperGame {
@@ -2,29 +2,34 @@
 #include <sstream>
 #include <iomanip>
 #include <random>
+#include <ctime>
 
 // GameTimer implementation
 void GameTimer::start() {
     startTime = std::chrono::steady_clock::now();
+    elapsed = std::chrono::steady_clock::duration::zero();
     running = true;
 }
 
 void GameTimer::stop() {
     if (running) {
-        auto now = std::chrono::steady_clock::now();
-        elapsedSeconds = std::chrono::duration_cast<std::chrono::seconds>(
-            now - startTime).count();
+        elapsed = std::chrono::steady_clock::now() - startTime;
         running = false;
     }
 }
 
+std::chrono::steady_clock::duration GameTimer::current() const {
+    return running ? std::chrono::steady_clock::now() - startTime : elapsed;
+}
+
+int GameTimer::getElapsedMillis() const {
+    return static_cast<int>(
+        std::chrono::duration_cast<std::chrono::milliseconds>(current()).count());
+}
+
 int GameTimer::getElapsedSeconds() const {
-    if (running) {
-        auto now = std::chrono::steady_clock::now();
-        return std::chrono::duration_cast<std::chrono::seconds>(
-            now - startTime).count();
-    }
-    return elapsedSeconds;
+    return static_cast<int>(
+        std::chrono::duration_cast<std::chrono::seconds>(current()).count());
 }
 
 std::string GameTimer::getTimeString() const {
@@ -39,7 +44,8 @@ std::string GameTimer::getTimeString() const {
 
 // Minesweeper implementation
 Minesweeper::Minesweeper() : height(9), width(9), mines(10), 
-                gameOver(false), won(false), firstMove(true) {
+                gameOver(false), won(false), firstMove(true),
+                history(highscores.getDirectory()), clicks(0) {
     reset();
 }
 
@@ -58,6 +64,7 @@ void Minesweeper::reset() {
     gameOver = false;
     won = false;
     firstMove = true;
+    clicks = 0;
     timer.stop();
 }
 
@@ -138,32 +145,26 @@ bool Minesweeper::checkWin() {
     return true;
 }
 
-bool Minesweeper::isHighScore(int time, const std::string& difficulty) {
-    const auto& scores = highscores.getScores();
-    int count = 0;
-    for (const auto& score : scores) {
-        if (score.difficulty == difficulty) {
-            count++;
-            if (count >= 10 && score.time <= time) {
-                return false;
-            }
-        }
-    }
-    return count < 10 || time < scores.back().time;
+bool Minesweeper::isHighScore(int timeMs) {
+    // Custom boards have their own leaderboard per width, height and mines
+    return highscores.isHighScore(timeMs, width, height, mines);
 }
 
 void Minesweeper::saveHighscore() {
-    std::string difficultyStr;
-    switch (width) {
-        case 9: difficultyStr = "Easy"; break;
-        case 16: difficultyStr = "Medium"; break;
-        case 30: difficultyStr = "Hard"; break;
-        default: difficultyStr = "Unknown"; break;  // Handle custom board sizes (should never hit this)
-    }
-    
     Score score;
     score.name = playerName;
-    score.time = timer.getElapsedSeconds();
-    score.difficulty = difficultyStr;
+    score.timeMs = timer.getElapsedMillis();
+    score.difficulty = Highscores::boardName(width, height, mines);
     highscores.addScore(score);
 }
+
+void Minesweeper::recordGame(GameOutcome outcome) {
+    GameRecord game;
+    game.board = Highscores::packBoard(width, height, mines);
+    game.timeMs = timer.getElapsedMillis();
+    game.bbbv = count3BV(minefield);
+    game.clicks = clicks;
+    game.outcome = outcome;
+    game.date = static_cast<uint32_t>(std::time(nullptr));
+    history.record(game);
+}